@@ -0,0 +1,22 @@
+#include <TinyStaticScheduler.h>
+
+
+const int LED_PIN = LED_BUILTIN;
+int LED_VALUE = 0;
+
+void toggleLed() {
+  LED_VALUE = (LED_VALUE + 1) % 2;
+  digitalWrite(LED_PIN, LED_VALUE);
+}
+
+TinyStaticScheduler<Every<1000, toggleLed>> msScheduler = TinyStaticScheduler<Every<1000, toggleLed>>::millis();
+
+void setup() {
+  pinMode(LED_PIN, OUTPUT);
+  digitalWrite(LED_PIN, LED_VALUE);
+  msScheduler.start();
+}
+
+void loop() {
+  msScheduler.loop();
+}
@@ -1,4 +1,5 @@
 #include "Arduino.h"
+#include "Clock.h"
 #include <chrono>
 #include <sys/time.h>
 #include <unistd.h>
@@ -7,7 +8,7 @@ auto start_time = std::chrono::steady_clock::now();
 
 void delay(unsigned long ms) { usleep(ms * 1000); }
 
-void delayMicroseconds(unsigned int us) { usleep(us); }
+void delayMicroseconds(unsigned int us) { preciseDelay(us * 1000UL); }
 
 unsigned long pulseIn(uint8_t pin, byte value) { return pulseIn(pin, value, 1000000); }
 
@@ -3,6 +3,7 @@
 
 #include <inttypes.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -199,18 +200,71 @@ protected:
   int findMulti(struct MultiTarget* targets, int tCount);
 };
 
-class LinuxSerial : public Stream {
+/**
+ * Output stream collecting writes in a fixed buffer, written to fd when it is full or flushed.
+ * With startWriter() a background thread writes one buffer while the other one is filled,
+ * so flush() only waits if the writer is still busy with the previous buffer
+ */
+class BufferedStream : public Stream {
 public:
-  void begin(int bd){};
+  static const size_t CAPACITY = 4096;
+
+  BufferedStream(int fd, bool lineBuffered = false);
+  virtual ~BufferedStream();
+
   int available() { return 0; };
   int read() { return -1; };
   int peek() { return -1; };
-  void flush(){};
-  size_t write(uint8_t c) {
-    char serial_buffer[256];
-    sprintf(serial_buffer, "%c", c);
-    printf(serial_buffer);
-    return strlen(serial_buffer);
+  void flush();
+
+  using Print::write;
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buffer, size_t size);
+
+  void startWriter();
+  /**
+   * flushes and joins the writer thread
+   */
+  void stopWriter();
+
+protected:
+  /**
+   * writes a full block, called from the writer thread once it is started
+   */
+  virtual void sink(const uint8_t* buffer, size_t size);
+
+private:
+  int fd;
+  bool lineBuffered;
+  uint8_t buffers[2][CAPACITY];
+  uint8_t* front;
+  size_t size;
+
+  bool writing;
+  bool stopping;
+  uint8_t* back;
+  size_t pending;
+  pthread_t writer;
+  pthread_mutex_t mutex;
+  pthread_cond_t ready;
+  pthread_cond_t done;
+
+  static void* run(void* stream);
+};
+
+/**
+ * line buffered stdout, written with stdio so it keeps its order with printf
+ */
+class LinuxSerial : public BufferedStream {
+public:
+  LinuxSerial() : BufferedStream(1, true){};
+  ~LinuxSerial() { this->stopWriter(); };
+  void begin(int bd){};
+
+protected:
+  void sink(const uint8_t* buffer, size_t size) {
+    fwrite(buffer, 1, size, stdout);
+    fflush(stdout);
   };
 };
 
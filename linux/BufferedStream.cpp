@@ -0,0 +1,128 @@
+#include "Arduino.h"
+#include <errno.h>
+#include <unistd.h>
+
+BufferedStream::BufferedStream(int fd, bool lineBuffered)
+    : fd(fd), lineBuffered(lineBuffered), front(buffers[0]), size(0), writing(false), stopping(false), back(buffers[1]), pending(0) {
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&ready, NULL);
+  pthread_cond_init(&done, NULL);
+}
+
+BufferedStream::~BufferedStream() {
+  stopWriter();
+  pthread_cond_destroy(&done);
+  pthread_cond_destroy(&ready);
+  pthread_mutex_destroy(&mutex);
+}
+
+size_t BufferedStream::write(uint8_t c) {
+  if (size == CAPACITY) {
+    flush();
+  }
+  front[size++] = c;
+  if (lineBuffered && c == '\n') {
+    flush();
+  }
+  return 1;
+}
+
+size_t BufferedStream::write(const uint8_t* buffer, size_t length) {
+  if (lineBuffered) {
+    for (size_t i = 0; i < length; i++) {
+      write(buffer[i]);
+    }
+    return length;
+  }
+  size_t left = length;
+  while (left > 0) {
+    if (size == CAPACITY) {
+      flush();
+    }
+    size_t chunk = min(left, CAPACITY - size);
+    memcpy(front + size, buffer, chunk);
+    size += chunk;
+    buffer += chunk;
+    left -= chunk;
+  }
+  return length;
+}
+
+void BufferedStream::flush() {
+  if (size == 0) {
+    return;
+  }
+  if (!writing) {
+    sink(front, size);
+    size = 0;
+    return;
+  }
+  pthread_mutex_lock(&mutex);
+  while (pending != 0) {
+    pthread_cond_wait(&done, &mutex);
+  }
+  uint8_t* full = front;
+  front = back;
+  back = full;
+  pending = size;
+  size = 0;
+  pthread_cond_signal(&ready);
+  pthread_mutex_unlock(&mutex);
+}
+
+void BufferedStream::startWriter() {
+  if (writing) {
+    return;
+  }
+  stopping = false;
+  writing = pthread_create(&writer, NULL, BufferedStream::run, this) == 0;
+}
+
+void BufferedStream::stopWriter() {
+  flush();
+  if (!writing) {
+    return;
+  }
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_signal(&ready);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(writer, NULL);
+  writing = false;
+}
+
+void BufferedStream::sink(const uint8_t* buffer, size_t length) {
+  while (length > 0) {
+    ssize_t written = ::write(fd, buffer, length);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      setWriteError();
+      return;
+    }
+    buffer += written;
+    length -= written;
+  }
+}
+
+void* BufferedStream::run(void* argument) {
+  BufferedStream* stream = (BufferedStream*) argument;
+  pthread_mutex_lock(&stream->mutex);
+  while (true) {
+    while (stream->pending == 0 && !stream->stopping) {
+      pthread_cond_wait(&stream->ready, &stream->mutex);
+    }
+    if (stream->pending == 0) {
+      break;
+    }
+    size_t length = stream->pending;
+    pthread_mutex_unlock(&stream->mutex);
+    stream->sink(stream->back, length);
+    pthread_mutex_lock(&stream->mutex);
+    stream->pending = 0;
+    pthread_cond_signal(&stream->done);
+  }
+  pthread_mutex_unlock(&stream->mutex);
+  return NULL;
+}
@@ -0,0 +1,201 @@
+#include "Clock.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <vector>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * 64 bits even where unsigned long is 32 bits, which would wrap every ~4.3 s
+ */
+static unsigned long long readClock(clockid_t clock) {
+  struct timespec time;
+  clock_gettime(clock, &time);
+  return (unsigned long long) time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+#if TINY_CLOCK_NANOS
+
+unsigned long coarseNanos() {
+#ifdef CLOCK_MONOTONIC_COARSE
+  return readClock(CLOCK_MONOTONIC_COARSE);
+#else
+  return readClock(CLOCK_MONOTONIC);
+#endif
+}
+
+#endif
+
+#if defined(__x86_64__)
+
+static bool hasInvariantTsc() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 5, "flags") == 0) {
+      return line.find(" constant_tsc") != std::string::npos && line.find(" nonstop_tsc") != std::string::npos;
+    }
+  }
+  return false;
+}
+
+static bool isKernelClocksource() {
+  std::ifstream source("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+  std::string name;
+  return std::getline(source, name) && name == "tsc";
+}
+
+/**
+ * ns = base + (cycles - baseCycles) * mult >> 32, measured over a 10 ms sleep
+ */
+struct TscCalibration {
+  bool stable;
+  unsigned long long baseCycles;
+  unsigned long long base;
+  unsigned long long mult;
+
+  TscCalibration() : stable(hasInvariantTsc() && isKernelClocksource()), baseCycles(0), base(0), mult(0) {
+    if (!this->stable) {
+      return;
+    }
+    unsigned long long start = readClock(CLOCK_MONOTONIC);
+    unsigned long long startCycles = __rdtsc();
+    struct timespec wait = {0, 10000000};
+    nanosleep(&wait, NULL);
+    unsigned long long end = readClock(CLOCK_MONOTONIC);
+    unsigned long long endCycles = __rdtsc();
+    if (endCycles <= startCycles) {
+      this->stable = false;
+      return;
+    }
+    this->mult = (unsigned long long) (((unsigned __int128) (end - start) << 32) / (endCycles - startCycles));
+    this->base = end;
+    this->baseCycles = endCycles;
+  }
+};
+
+static const TscCalibration& calibration() {
+  static const TscCalibration tsc;
+  return tsc;
+}
+
+unsigned long tscNanos() {
+  const TscCalibration& tsc = calibration();
+  if (!tsc.stable) {
+    return readClock(CLOCK_MONOTONIC);
+  }
+  unsigned long long cycles = __rdtsc() - tsc.baseCycles;
+  return tsc.base + (unsigned long) (((unsigned __int128) cycles * tsc.mult) >> 32);
+}
+
+bool isTscStable() { return calibration().stable; }
+
+#else
+
+#if TINY_CLOCK_NANOS
+unsigned long tscNanos() { return readClock(CLOCK_MONOTONIC); }
+#endif
+
+bool isTscStable() { return false; }
+
+#endif
+
+void nsDelay(unsigned long ns) {
+  struct timespec wait = {(time_t) (ns / 1000000000UL), (long) (ns % 1000000000UL)};
+  clock_nanosleep(CLOCK_MONOTONIC, 0, &wait, NULL);
+}
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+static std::atomic<unsigned long> spinThreshold(100000);
+static std::mutex statsMutex;
+static DelayStats stats;
+
+void setSpinThreshold(unsigned long ns) { spinThreshold = ns; }
+
+unsigned long getSpinThreshold() { return spinThreshold; }
+
+static void sleepUntil(unsigned long long deadline) {
+  struct timespec wake = {(time_t) (deadline / 1000000000ULL), (long) (deadline % 1000000000ULL)};
+  // interrupted by a signal the absolute deadline is still valid, other errors leave it to the spin
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {
+  }
+}
+
+void preciseDelay(unsigned long ns) {
+  const unsigned long long deadline = readClock(CLOCK_MONOTONIC) + ns;
+  const unsigned long threshold = spinThreshold;
+  if (ns > threshold) {
+    sleepUntil(deadline - threshold);
+  }
+  unsigned long long now;
+  while ((now = readClock(CLOCK_MONOTONIC)) < deadline) {
+    cpuRelax();
+  }
+  std::lock_guard<std::mutex> lock(statsMutex);
+  stats.add((unsigned long) (now - deadline));
+}
+
+unsigned long calibrateSpinThreshold(unsigned int samples, double percentile) {
+  std::vector<unsigned long> errors;
+  errors.reserve(samples);
+  for (unsigned int i = 0; i < samples; i++) {
+    const unsigned long long deadline = readClock(CLOCK_MONOTONIC) + 200000;
+    sleepUntil(deadline);
+    errors.push_back((unsigned long) (readClock(CLOCK_MONOTONIC) - deadline));
+  }
+  if (!errors.empty()) {
+    std::sort(errors.begin(), errors.end());
+    setSpinThreshold(errors[(size_t) (percentile * (errors.size() - 1))]);
+  }
+  return spinThreshold;
+}
+
+DelayStats::DelayStats() : count(0), total(0), max(0), buckets() {}
+
+unsigned long DelayStats::mean() const { return this->count == 0 ? 0 : this->total / this->count; }
+
+unsigned long DelayStats::percentile(double fraction) const {
+  if (this->count == 0) {
+    return 0;
+  }
+  const unsigned long rank = std::min((unsigned long) (fraction * this->count), this->count - 1);
+  unsigned long seen = 0;
+  for (unsigned int i = 0; i < BUCKETS; i++) {
+    seen += this->buckets[i];
+    if (seen > rank) {
+      return (unsigned long) std::min(i == 0 ? 0ULL : (1ULL << i) - 1, (unsigned long long) this->max);
+    }
+  }
+  return this->max;
+}
+
+void DelayStats::add(unsigned long error) {
+  unsigned int bucket = error == 0 ? 0 : 64 - __builtin_clzll(error);
+  this->buckets[std::min(bucket, BUCKETS - 1)] += 1;
+  this->count += 1;
+  this->total += error;
+  this->max = std::max(this->max, error);
+}
+
+DelayStats getDelayStats() {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  return stats;
+}
+
+void resetDelayStats() {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  stats = DelayStats();
+}
@@ -0,0 +1,88 @@
+#ifndef __LINUX_CLOCK__
+#define __LINUX_CLOCK__
+
+#include <climits>
+
+/**
+ * Nanosecond time providers for Linux, cheaper to read than millis()/micros():
+ *
+ *   TinyScheduler scheduler(tscNanos, nsDelay, 1000000000);
+ *
+ * They return unsigned long like any time provider, so they are only declared on
+ * LP64 targets (x86_64, aarch64) where it is 64 bits and they wrap after ~584 years.
+ * On 32 bits targets (e.g. Raspberry Pi OS on ARM) they would wrap every ~4.3 s.
+ * The time stamp counter is only read on x86_64.
+ */
+#if ULONG_MAX > 0xFFFFFFFFUL
+#define TINY_CLOCK_NANOS 1
+#else
+#define TINY_CLOCK_NANOS 0
+#endif
+
+#if TINY_CLOCK_NANOS
+
+/**
+ * CLOCK_MONOTONIC_COARSE, updated once per kernel tick (1-4 ms) but read without a syscall
+ */
+unsigned long coarseNanos();
+
+/**
+ * time stamp counter scaled to nanoseconds, calibrated against CLOCK_MONOTONIC on the
+ * first call. Falls back to CLOCK_MONOTONIC when the counter is not invariant or the
+ * kernel does not use it as its clocksource
+ */
+unsigned long tscNanos();
+
+#endif
+
+/**
+ * returns true if tscNanos() reads the time stamp counter
+ */
+bool isTscStable();
+
+void nsDelay(unsigned long ns);
+
+/**
+ * waits with an absolute clock_nanosleep until the spin threshold before the deadline,
+ * then spins on CLOCK_MONOTONIC with the pause instruction. delayMicroseconds() uses it,
+ * trading up to one threshold of busy CPU per wait for the sleep overshoot
+ */
+void preciseDelay(unsigned long ns);
+
+/**
+ * 0 always sleeps, larger values spin longer but absorb more of the scheduler wake up latency
+ */
+void setSpinThreshold(unsigned long ns);
+unsigned long getSpinThreshold();
+
+/**
+ * sets the spin threshold to the given percentile of the overshoot of samples short sleeps
+ * (about 200 us each), returning it
+ */
+unsigned long calibrateSpinThreshold(unsigned int samples = 200, double percentile = 0.99);
+
+/**
+ * overshoot of the precise delays past their deadline, in log2 nanosecond buckets
+ */
+struct DelayStats {
+  static const unsigned int BUCKETS = 64;
+
+  unsigned long count;
+  unsigned long total;
+  unsigned long max;
+  // buckets[i] counts the errors below 2^i ns (and at least 2^(i-1))
+  unsigned long buckets[BUCKETS];
+
+  DelayStats();
+  unsigned long mean() const;
+  /**
+   * upper bound of the error below which the given fraction (e.g. 0.99) of the delays fall
+   */
+  unsigned long percentile(double fraction) const;
+  void add(unsigned long error);
+};
+
+DelayStats getDelayStats();
+void resetDelayStats();
+
+#endif
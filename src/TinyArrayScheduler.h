@@ -0,0 +1,277 @@
+/**
+ * TinyArrayScheduler.h
+ *
+ * A bounded capacity scheduler keeping its deadlines in contiguous arrays
+ * (structure of arrays) instead of linked nodes, due tasks are found with a
+ * vectorized scan (AVX2/SSE on x86, scalar elsewhere).
+ *
+ * Deadlines are 32 bits and compared with a wrap safe difference, so delays
+ * must be shorter than half the range of the time provider (~24 days for millis).
+ */
+
+#ifndef __TINY_ARRAY_SCHEDULER__
+#define __TINY_ARRAY_SCHEDULER__
+
+#include "TinyScheduler.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+template<unsigned int Capacity>
+class TinyArrayScheduler {
+  // handles and indexes are kept in 16 bits
+  static_assert(Capacity <= 65535, "at most 65535 tasks");
+
+public:
+
+  typedef void (*Callback)();
+
+  TinyArrayScheduler(TimeProvider timeProvider, Delay delay) : timeProvider(timeProvider), delay(delay) {
+    for(unsigned int i = 0; i < Capacity; i++) {
+      this->slot[i] = i;
+      this->index[i] = i;
+    }
+  }
+  static TinyArrayScheduler millis() {
+    return TinyArrayScheduler(::millis, ::delay);
+  }
+  static TinyArrayScheduler micros() {
+    return TinyArrayScheduler(::micros, usDelay);
+  }
+
+  /**
+   * returns the handle of the task or -1 if the scheduler is full
+   */
+  int timeout(unsigned long delta, Callback callback) {
+    return this->add(delta, 0, 0, callback);
+  }
+
+  int every(unsigned long interval, Callback callback) {
+    return this->add(interval, interval, PERIODIC, callback);
+  }
+
+  int every(unsigned long firstInterval, unsigned long interval, Callback callback) {
+    return this->add(firstInterval, interval, PERIODIC, callback);
+  }
+
+  bool cancel(int handle) {
+    if(!this->isPending(handle)) {
+      return false;
+    }
+    this->removeAt(this->index[handle]);
+    return true;
+  }
+
+  /**
+   * moves a pending task to delta from now
+   */
+  bool reschedule(int handle, unsigned long delta) {
+    if(!this->isPending(handle)) {
+      return false;
+    }
+    this->when[this->index[handle]] = (uint32_t) this->timeProvider() + (uint32_t) delta;
+    return true;
+  }
+
+  bool isPending(int handle) const {
+    return handle >= 0 && (unsigned int) handle < Capacity && this->index[handle] < this->size;
+  }
+
+  /**
+   * reads the clock again once anything ran, so the wait is counted from the fresh time
+   */
+  unsigned long tick() {
+    uint32_t now = this->timeProvider();
+    if(this->drain(now)) {
+      now = this->timeProvider();
+      if(this->drain(now) && this->size != 0) {
+        return 0;
+      }
+    }
+    return this->leftTime(now);
+  }
+
+  void loop() {
+    while(!this->isEmpty()) {
+      const unsigned long wait = this->tick();
+      if(wait != 0) {
+        this->delay(wait);
+      }
+    }
+  }
+
+  bool isEmpty() const {
+    return this->size == 0;
+  }
+
+  unsigned int count() const {
+    return this->size;
+  }
+
+  void clear() {
+    this->size = 0;
+  }
+
+private:
+
+  static const uint8_t PERIODIC = 1;
+
+  TimeProvider timeProvider;
+  Delay delay;
+  unsigned int size = 0;
+
+  // dense arrays, the first size entries are the pending tasks
+  uint32_t when[Capacity];
+  uint32_t interval[Capacity];
+  uint8_t flags[Capacity];
+  // handle of each entry, entries past size hold the free handles
+  uint16_t slot[Capacity];
+
+  // indexed by handle
+  uint16_t index[Capacity];
+  Callback callbacks[Capacity];
+  uint16_t due[Capacity];
+
+  bool drain(uint32_t now) {
+    bool ran = false;
+    unsigned int found;
+    while((found = this->collect(now)) != 0) {
+      for(unsigned int i = 0; i < found; i++) {
+        this->fire(this->due[i], now);
+      }
+      ran = true;
+    }
+    return ran;
+  }
+
+  int add(unsigned long delta, unsigned long interval, uint8_t flags, Callback callback) {
+    if(this->size == Capacity) {
+      return -1;
+    }
+    unsigned int i = this->size++;
+    uint16_t handle = this->slot[i];
+    this->when[i] = (uint32_t) this->timeProvider() + (uint32_t) delta;
+    this->interval[i] = interval;
+    this->flags[i] = flags;
+    this->callbacks[handle] = callback;
+    return handle;
+  }
+
+  /**
+   * swaps the entry with the last pending one, so the pending entries stay contiguous
+   */
+  void removeAt(unsigned int i) {
+    unsigned int last = --this->size;
+    uint16_t handle = this->slot[i];
+    this->when[i] = this->when[last];
+    this->interval[i] = this->interval[last];
+    this->flags[i] = this->flags[last];
+    this->slot[i] = this->slot[last];
+    this->index[this->slot[i]] = i;
+    this->slot[last] = handle;
+    this->index[handle] = last;
+  }
+
+  /**
+   * a callback may have cancelled or moved the task since it was collected
+   */
+  void fire(uint16_t handle, uint32_t now) {
+    if(this->index[handle] >= this->size) {
+      return;
+    }
+    unsigned int i = this->index[handle];
+    if((int32_t) (this->when[i] - now) > 0) {
+      return;
+    }
+    Callback callback = this->callbacks[handle];
+    if(this->flags[i] & PERIODIC) {
+      this->when[i] += this->interval[i];
+    }
+    else {
+      this->removeAt(i);
+    }
+    callback();
+  }
+
+  /**
+   * stores the handles of the due tasks, returning how many there are
+   */
+  unsigned int collect(uint32_t now) {
+    unsigned int found = 0;
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    const __m256i now8 = _mm256_set1_epi32(now);
+    const __m256i zero8 = _mm256_setzero_si256();
+    for(; i + 8 <= this->size; i += 8) {
+      __m256i diff = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*) (this->when + i)), now8);
+      int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(diff, zero8))) & 0xFF;
+      while(mask != 0) {
+        this->due[found++] = this->slot[i + __builtin_ctz(mask)];
+        mask &= mask - 1;
+      }
+    }
+#elif defined(__SSE2__)
+    const __m128i now4 = _mm_set1_epi32(now);
+    const __m128i zero4 = _mm_setzero_si128();
+    for(; i + 4 <= this->size; i += 4) {
+      __m128i diff = _mm_sub_epi32(_mm_loadu_si128((const __m128i*) (this->when + i)), now4);
+      int mask = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(diff, zero4))) & 0xF;
+      while(mask != 0) {
+        this->due[found++] = this->slot[i + __builtin_ctz(mask)];
+        mask &= mask - 1;
+      }
+    }
+#endif
+    for(; i < this->size; i++) {
+      if((int32_t) (this->when[i] - now) <= 0) {
+        this->due[found++] = this->slot[i];
+      }
+    }
+    return found;
+  }
+
+  /**
+   * time until the earliest deadline, 0 if there is none
+   */
+  unsigned long leftTime(uint32_t now) const {
+    if(this->size == 0) {
+      return 0;
+    }
+    int32_t left = this->when[0] - now;
+    unsigned int i = 1;
+#if defined(__AVX2__)
+    const __m256i now8 = _mm256_set1_epi32(now);
+    __m256i left8 = _mm256_set1_epi32(left);
+    for(; i + 8 <= this->size; i += 8) {
+      __m256i diff = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*) (this->when + i)), now8);
+      left8 = _mm256_min_epi32(left8, diff);
+    }
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i*) lanes, left8);
+    for(unsigned int lane = 0; lane < 8; lane++) {
+      left = lanes[lane] < left ? lanes[lane] : left;
+    }
+#elif defined(__SSE4_1__)
+    const __m128i now4 = _mm_set1_epi32(now);
+    __m128i left4 = _mm_set1_epi32(left);
+    for(; i + 4 <= this->size; i += 4) {
+      __m128i diff = _mm_sub_epi32(_mm_loadu_si128((const __m128i*) (this->when + i)), now4);
+      left4 = _mm_min_epi32(left4, diff);
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*) lanes, left4);
+    for(unsigned int lane = 0; lane < 4; lane++) {
+      left = lanes[lane] < left ? lanes[lane] : left;
+    }
+#endif
+    for(; i < this->size; i++) {
+      int32_t diff = this->when[i] - now;
+      left = diff < left ? diff : left;
+    }
+    return left > 0 ? left : 0;
+  }
+
+};
+
+#endif
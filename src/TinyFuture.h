@@ -0,0 +1,235 @@
+/**
+ * TinyFuture.h
+ *
+ * Results of scheduled callables for other threads:
+ *
+ *   TinyFuture<int> future = scheduler.timeoutAsync(100, []() { return readSensor(); });
+ *   int value = future.get(); // from another thread, blocks until the task has run
+ *
+ * The shared state is part of the scheduled node, which is freed once both the
+ * scheduler and the last future are done with it. The scheduler itself is not thread
+ * safe, only the futures are meant to be used from other threads.
+ * Needs std::mutex, so it is meant for Linux, ESP32 and similar targets.
+ */
+
+#ifndef __TINY_FUTURE__
+#define __TINY_FUTURE__
+
+#include "TinyScheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+template<typename Result>
+class TinyFutureState {
+public:
+  enum Status {
+    PENDING,
+    READY,
+    // removed from the scheduler before it could run
+    CANCELLED
+  };
+
+  void retain() {
+    this->references.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void releaseReference() {
+    if(this->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->destroy();
+    }
+  }
+
+  Status wait() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->changed.wait(lock, [this]() {
+      return this->status != PENDING;
+    });
+    return this->status;
+  }
+
+  Status waitFor(unsigned long ms) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->changed.wait_for(lock, std::chrono::milliseconds(ms), [this]() {
+      return this->status != PENDING;
+    });
+    return this->status;
+  }
+
+  Status poll() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->status;
+  }
+
+  Result& value() {
+    return this->result;
+  }
+
+protected:
+  virtual ~TinyFutureState() {}
+  virtual void destroy() = 0;
+
+  void finish(Status status) {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if(this->status != PENDING) {
+        return;
+      }
+      this->status = status;
+    }
+    this->changed.notify_all();
+  }
+
+  Result result = Result();
+
+private:
+  // the scheduler holds the first reference
+  std::atomic<unsigned int> references{1};
+  std::mutex mutex;
+  std::condition_variable changed;
+  Status status = PENDING;
+};
+
+/**
+ * void callables store nothing
+ */
+struct TinyFutureVoid {};
+
+template<typename Result>
+struct TinyFutureResult {
+  typedef Result type;
+
+  template<typename Callable>
+  static void call(Callable& callable, Result& result) {
+    result = callable();
+  }
+};
+
+template<>
+struct TinyFutureResult<void> {
+  typedef TinyFutureVoid type;
+
+  template<typename Callable>
+  static void call(Callable& callable, TinyFutureVoid& result) {
+    callable();
+  }
+};
+
+template<typename Result>
+class TinyFuture {
+public:
+  typedef typename TinyFutureResult<Result>::type Value;
+  typedef TinyFutureState<Value> State;
+
+  TinyFuture() : state(NULL) {}
+
+  explicit TinyFuture(State* state) : state(state) {
+    if(this->state != NULL) {
+      this->state->retain();
+    }
+  }
+
+  TinyFuture(const TinyFuture& future) : TinyFuture(future.state) {}
+
+  TinyFuture(TinyFuture&& future) : state(future.state) {
+    future.state = NULL;
+  }
+
+  TinyFuture& operator=(TinyFuture future) {
+    std::swap(this->state, future.state);
+    return *this;
+  }
+
+  ~TinyFuture() {
+    if(this->state != NULL) {
+      this->state->releaseReference();
+    }
+  }
+
+  bool isValid() const {
+    return this->state != NULL;
+  }
+
+  /**
+   * returns true once the callable has run, without blocking
+   */
+  bool isReady() const {
+    return this->state->poll() == State::READY;
+  }
+
+  bool isCancelled() const {
+    return this->state->poll() == State::CANCELLED;
+  }
+
+  /**
+   * blocks until the callable has run or is cancelled, returns true if it has run
+   */
+  bool wait() const {
+    return this->state->wait() == State::READY;
+  }
+
+  /**
+   * returns false if the callable has not run after ms milliseconds
+   */
+  bool waitFor(unsigned long ms) const {
+    return this->state->waitFor(ms) == State::READY;
+  }
+
+  /**
+   * blocks until the callable has run, a cancelled callable returns a default value
+   */
+  Value get() const {
+    this->state->wait();
+    return this->state->value();
+  }
+
+private:
+  State* state;
+};
+
+template<typename Scheduler, typename Callable>
+struct TinyAsync {
+  typedef typename TinyDecay<Callable>::type Type;
+  typedef decltype(std::declval<Type&>()()) Result;
+  typedef TinyFuture<Result> Future;
+  typedef typename Future::Value Value;
+
+  class Node: public Scheduler::Node, public TinyFutureState<Value> {
+    public:
+      template<typename Time, typename Argument>
+      Node(Time when, Argument&& callable) : Scheduler::Node(when), callable(tinyForward<Argument>(callable)) {
+
+      }
+
+      bool run() {
+        TinyFutureResult<Result>::call(this->callable, this->result);
+        this->finish(TinyFutureState<Value>::READY);
+        return true;
+      }
+
+      bool isOneShot() const {
+        return true;
+      }
+
+      /**
+       * the scheduler drops its reference, futures may still hold the node
+       */
+      void dispose() {
+        this->finish(TinyFutureState<Value>::CANCELLED);
+        this->releaseReference();
+      }
+
+    protected:
+      void destroy() {
+        delete this;
+      }
+
+    private:
+      Type callable;
+  };
+};
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * TinyHybridScheduler.h
+ *
+ * Two schedulers behind one interface: a millisecond queue for long timers and a
+ * microsecond queue for short, precision critical ones.
+ *
+ *   TinyHybridScheduler scheduler;
+ *   scheduler.every(500, pulse);            // microseconds, fine queue
+ *   scheduler.every(3600000000ULL, report); // an hour, coarse queue
+ *
+ * Delays are given in microseconds and routed by the threshold, delays below it go
+ * to the fine queue. Coarse delays are rounded up to the next millisecond so they do
+ * not fire early, and the fine queue only wraps through its overflow rescan while short
+ * tasks are pending.
+ */
+
+#ifndef __TINY_HYBRID_SCHEDULER__
+#define __TINY_HYBRID_SCHEDULER__
+
+#include "TinyScheduler.h"
+
+class TinyHybridScheduler {
+public:
+
+  typedef TinyScheduler::Node Node;
+  typedef unsigned long long Micros;
+
+  /**
+   * threshold is the shortest delay in microseconds handled by the millisecond queue
+   */
+  TinyHybridScheduler(unsigned long threshold = 10000, TimeProvider millisProvider = ::millis, TimeProvider microsProvider = ::micros) :
+    threshold(threshold), coarseQueue(millisProvider, ::delay, 1000), fineQueue(microsProvider, usDelay, 1000000) {
+
+  }
+
+  template<typename Callable>
+  TinyHybridScheduler& timeout(Micros delta, Callable&& callable) {
+    if(this->isFine(delta)) {
+      this->fineQueue.timeout(delta, tinyForward<Callable>(callable));
+      this->lastQueue = &this->fineQueue;
+    }
+    else {
+      this->coarseQueue.timeout(toMillis(delta), tinyForward<Callable>(callable));
+      this->lastQueue = &this->coarseQueue;
+    }
+    return *this;
+  }
+
+  template<typename Callable>
+  TinyHybridScheduler& every(Micros interval, Callable&& callable) {
+    if(this->isFine(interval)) {
+      this->fineQueue.every(interval, tinyForward<Callable>(callable));
+      this->lastQueue = &this->fineQueue;
+    }
+    else {
+      this->coarseQueue.every(toMillis(interval), tinyForward<Callable>(callable));
+      this->lastQueue = &this->coarseQueue;
+    }
+    return *this;
+  }
+
+  template<typename Callable>
+  TinyHybridScheduler& repeat(unsigned int times, Micros interval, Callable&& callable) {
+    if(this->isFine(interval)) {
+      this->fineQueue.repeat(times, interval, tinyForward<Callable>(callable));
+      this->lastQueue = &this->fineQueue;
+    }
+    else {
+      this->coarseQueue.repeat(times, toMillis(interval), tinyForward<Callable>(callable));
+      this->lastQueue = &this->coarseQueue;
+    }
+    return *this;
+  }
+
+  /**
+   * ticks both queues, returning the microseconds left until the earliest deadline
+   * or 0 if there is nothing pending
+   */
+  unsigned long tick() {
+    return tickAll(this->coarseQueue, this->fineQueue);
+  }
+
+  void loop() {
+    loopAll(this->coarseQueue, this->fineQueue);
+  }
+
+  /**
+   * the last task added, read from the queue it went to so it is NULL once the task is done
+   */
+  Node* last() const {
+    if(this->lastQueue == NULL) {
+      return NULL;
+    }
+    return this->lastQueue->last();
+  }
+
+  bool isEmpty() const {
+    return this->coarseQueue.isEmpty() && this->fineQueue.isEmpty();
+  }
+
+  unsigned int count() const {
+    return this->coarseQueue.count() + this->fineQueue.count();
+  }
+
+  void clear() {
+    this->lastQueue = NULL;
+    this->coarseQueue.clear();
+    this->fineQueue.clear();
+  }
+
+  /**
+   * the underlying queues, e.g. for groups or rate limiters in a given resolution
+   */
+  TinyScheduler& coarse() {
+    return this->coarseQueue;
+  }
+
+  TinyScheduler& fine() {
+    return this->fineQueue;
+  }
+
+private:
+  unsigned long threshold;
+  TinyScheduler coarseQueue;
+  TinyScheduler fineQueue;
+  TinyScheduler* lastQueue = NULL;
+
+  bool isFine(Micros delta) const {
+    return delta < this->threshold;
+  }
+
+  static unsigned long toMillis(Micros delta) {
+    return (delta + 999) / 1000;
+  }
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * TinyLoopMetrics.h
+ *
+ * Hooks policy splitting the time of loop() between running tasks and waiting:
+ *
+ *   BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyLoopMetrics> scheduler(millis, delay);
+ *   scheduler.hooks().begin(millis, 1000);
+ *
+ * The time provider is read at each transition, so the busy time includes the
+ * scheduler overhead and the idle time includes the delay overshoot.
+ * An iteration is saturated when tick() returned no wait while tasks are pending,
+ * tasks became due while others ran, so the loop is behind its deadlines.
+ * The utilization covers the last window, kept in SLOTS slots of window / SLOTS.
+ */
+
+#ifndef __TINY_LOOP_METRICS__
+#define __TINY_LOOP_METRICS__
+
+#include "TinyScheduler.h"
+
+class TinyLoopMetrics : public TinyNoHooks {
+public:
+
+  static const unsigned int SLOTS = 8;
+
+  /**
+   * window is in time provider units, the loop counts as busy from now
+   */
+  void begin(TimeProvider timeProvider, unsigned long window) {
+    this->timeProvider = timeProvider;
+    this->slotLength = window < SLOTS ? 1 : window / SLOTS;
+    this->started = this->timeProvider();
+    this->mark = this->started;
+    this->slotStart = this->started;
+    this->sleeping = false;
+    for(unsigned int i = 0; i < SLOTS; i++) {
+      this->slots[i] = 0;
+    }
+  }
+
+  template<typename Node>
+  void onDispatchBegin(const Node& node) {
+    this->wake();
+  }
+
+  template<typename Time>
+  void onIdle(Time wait) {
+    if(this->timeProvider == NULL) {
+      return;
+    }
+    this->wake();
+    if(wait == 0) {
+      this->saturated += 1;
+      return;
+    }
+    this->sleeping = true;
+  }
+
+  unsigned long getBusy() const {
+    return this->busy;
+  }
+
+  unsigned long getIdle() const {
+    return this->idle;
+  }
+
+  /**
+   * loop() iterations that had no time left to wait
+   */
+  unsigned long getSaturated() const {
+    return this->saturated;
+  }
+
+  /**
+   * percentage of the last window spent running tasks, the current span included
+   */
+  unsigned int getUtilization() {
+    if(this->timeProvider == NULL) {
+      return 0;
+    }
+    this->account(this->timeProvider());
+    unsigned long busy = 0;
+    for(unsigned int i = 0; i < SLOTS; i++) {
+      busy += this->slots[i];
+    }
+    unsigned long covered = (SLOTS - 1) * this->slotLength + (this->mark - this->slotStart);
+    if(covered > this->mark - this->started) {
+      covered = this->mark - this->started;
+    }
+    if(covered == 0) {
+      return 0;
+    }
+    return (unsigned int) ((unsigned long long) busy * 100 / covered);
+  }
+
+private:
+  TimeProvider timeProvider = NULL;
+  unsigned long slotLength = 1;
+  unsigned long started = 0;
+  // last transition
+  unsigned long mark = 0;
+  unsigned long slotStart = 0;
+  unsigned int current = 0;
+  bool sleeping = false;
+  unsigned long busy = 0;
+  unsigned long idle = 0;
+  unsigned long saturated = 0;
+  unsigned long slots[SLOTS] = {};
+
+  void wake() {
+    if(this->timeProvider == NULL) {
+      return;
+    }
+    this->account(this->timeProvider());
+    this->sleeping = false;
+  }
+
+  /**
+   * adds the span since the last transition to the totals and to the slots it covers
+   */
+  void account(unsigned long now) {
+    const unsigned long fill = this->sleeping ? 0 : this->slotLength;
+    if(this->sleeping) {
+      this->idle += now - this->mark;
+    }
+    else {
+      this->busy += now - this->mark;
+    }
+    const unsigned long skipped = (now - this->slotStart) / this->slotLength;
+    if(skipped >= SLOTS) {
+      for(unsigned int i = 0; i < SLOTS; i++) {
+        this->slots[i] = fill;
+      }
+      this->slotStart += skipped * this->slotLength;
+      this->slots[this->current] = this->sleeping ? 0 : now - this->slotStart;
+      this->mark = now;
+      return;
+    }
+    unsigned long at = this->mark;
+    for(unsigned long i = 0; i < skipped; i++) {
+      const unsigned long end = this->slotStart + this->slotLength;
+      if(!this->sleeping) {
+        this->slots[this->current] += end - at;
+      }
+      at = end;
+      this->slotStart = end;
+      this->current = (this->current + 1) % SLOTS;
+      this->slots[this->current] = 0;
+    }
+    if(!this->sleeping) {
+      this->slots[this->current] += now - at;
+    }
+    this->mark = now;
+  }
+};
+
+#endif
@@ -20,116 +20,453 @@ public:
 
 typedef unsigned long (*TimeProvider)();
 typedef void (*Delay)(unsigned long);
+/**
+ * returns the seconds elapsed since the unix epoch (UTC)
+ */
+typedef unsigned long (*WallClock)();
 
 
 void usDelay(unsigned long us);
 
-class TinyScheduler {
+/**
+ * cron expression parsed into one bitset per field
+ */
+class TinyCron {
+  public:
+    TinyCron();
+    /**
+     * returns false if the expression is invalid
+     */
+    bool parse(const char* expression);
+    /**
+     * returns the first matching second (since the epoch) after the given one, or 0 if there is none
+     */
+    unsigned long next(unsigned long epoch) const;
+
+    void debug(Stream& stream) const;
+  private:
+    uint64_t minutes;
+    uint32_t hours;
+    uint32_t days;
+    uint16_t months;
+    uint8_t weekdays;
+    bool anyDay;
+    bool anyWeekday;
+
+    bool matchesDay(unsigned long day, unsigned int dayOfMonth) const;
+    static bool parseField(const char*& cursor, uint64_t& bits, unsigned int low, unsigned int high, bool& any);
+    static unsigned int parseNumber(const char*& cursor, bool& valid);
+    static int nextBit(uint64_t bits, unsigned int from);
+    static unsigned long toDays(unsigned int year, unsigned int month, unsigned int day);
+    static void fromDays(unsigned long days, unsigned int& year, unsigned int& month, unsigned int& day);
+    static unsigned int daysInMonth(unsigned int year, unsigned int month);
+};
+
+/**
+ * std::decay and std::forward, the AVR toolchain has no standard library.
+ * Callables are stored by value, functions as function pointers
+ */
+template<typename T> struct TinyDecay { typedef T type; };
+template<typename T> struct TinyDecay<T&> : TinyDecay<T> {};
+template<typename T> struct TinyDecay<T&&> : TinyDecay<T> {};
+template<typename T> struct TinyDecay<const T> : TinyDecay<T> {};
+template<typename T> struct TinyDecay<volatile T> : TinyDecay<T> {};
+template<typename T> struct TinyDecay<const volatile T> : TinyDecay<T> {};
+template<typename R, typename... Args> struct TinyDecay<R(Args...)> { typedef R (*type)(Args...); };
+
+template<typename T> struct TinyRemoveReference { typedef T type; };
+template<typename T> struct TinyRemoveReference<T&> { typedef T type; };
+template<typename T> struct TinyRemoveReference<T&&> { typedef T type; };
+
+template<typename T>
+T&& tinyForward(typename TinyRemoveReference<T>::type& value) {
+  return static_cast<T&&>(value);
+}
+
+template<typename T>
+T&& tinyForward(typename TinyRemoveReference<T>::type&& value) {
+  return static_cast<T&&>(value);
+}
+
+/**
+ * Default hooks policy, every call is inlined to nothing.
+ * A policy provides the same members, taking the node as a template argument,
+ * and is reached with scheduler.hooks()
+ */
+struct TinyNoHooks {
+  /**
+   * a task was added
+   */
+  template<typename Node> void onInsert(const Node& node) {}
+  template<typename Node> void onDispatchBegin(const Node& node) {}
+  /**
+   * done is true if the task will not run again, the node is released right after
+   */
+  template<typename Node> void onDispatchEnd(const Node& node, bool done) {}
+  /**
+   * the executor is about to run a batch, the onDispatchBegin of its tasks follow
+   */
+  void onBatchBegin() {}
+  /**
+   * the executor returned, the onDispatchEnd of the batch tasks follow
+   */
+  void onBatchEnd() {}
+  /**
+   * a pending task is removed by clear(), a group clear() or disarm()
+   */
+  template<typename Node> void onCancel(const Node& node) {}
+  /**
+   * the time provider wrapped around, the whole queue is walked
+   */
+  void onOverflowRescan() {}
+  /**
+   * loop() is about to wait for the next task, wait is 0 when tasks are due again already
+   */
+  template<typename Time> void onIdle(Time wait) {}
+};
+
+/**
+ * defined in TinyFuture.h, which is only needed by timeoutAsync()
+ */
+template<typename Scheduler, typename Callable> struct TinyAsync;
+
+/**
+ * Time, Interval and GroupId set the width of the fields stored in every node,
+ * the time provider is truncated to Time, so it has to be ticked at least once
+ * per Time range (~65 seconds for 16 bits millis).
+ * Hooks is a policy called on scheduler events, see TinyNoHooks.
+ */
+template<typename Time = unsigned long, typename Interval = Time, typename GroupId = unsigned long, typename Hooks = TinyNoHooks>
+class BasicTinyScheduler : private Hooks {
 public:
 
+  class Node;
   class Group;
+  typedef TinyCron Cron;
+  class RateLimiter;
+  class SharedBucket;
+  template<typename Callable> class Debounce;
+  template<typename Callable> class Throttle;
+  template<typename Callable> class BasicTask;
+  class Task;
+  struct Snapshot;
+
+  /**
+   * how every(interval, ...) picks the first run of periodic tasks
+   */
+  enum PhaseSpreading {
+    SPREAD_NONE,
+    // golden ratio hash of the registration order, same interval tasks land evenly apart
+    SPREAD_HASH,
+    // xorshift jitter within the interval
+    SPREAD_RANDOM
+  };
 
-  TinyScheduler(TimeProvider timeProvider, Delay delay);
-  static TinyScheduler millis() {
-    return TinyScheduler(::millis, ::delay);
+  /**
+   * resolution is the number of time units per second returned by the time provider
+   */
+  BasicTinyScheduler(TimeProvider timeProvider, Delay delay, unsigned long resolution = 1000);
+  static BasicTinyScheduler millis() {
+    return BasicTinyScheduler(::millis, ::delay, 1000);
   }
-  static TinyScheduler micros() {
-    return TinyScheduler(::micros, usDelay);
+  static BasicTinyScheduler micros() {
+    return BasicTinyScheduler(::micros, usDelay, 1000000);
   }
-  virtual ~TinyScheduler();
-  unsigned long tick();
+  virtual ~BasicTinyScheduler();
+  Hooks& hooks() {
+    return *this;
+  }
+  /**
+   * runs the due tasks and returns the time left until the next one, 0 if there is
+   * nothing pending or if tasks are due again already
+   */
+  Time tick();
   void loop();
+  /**
+   * converts a time returned by tick() to microseconds, saturating on overflow
+   */
+  unsigned long toMicros(Time time) const;
   bool isEmpty() const;
   unsigned int count() const;
   void debug(Stream& stream) const;
+  /**
+   * calls visitor(const Node&) for each pending task, earliest first, without allocating.
+   * The visitor must not add or remove tasks
+   */
+  template<typename Visitor>
+  void visit(Visitor&& visitor) const {
+    const Node* lists[] = { &this->head, &this->rearmed, &this->batch };
+    for(const Node* list : lists) {
+      for(const Node* node = list->next; node != NULL; node = node->next) {
+        visitor(*node);
+      }
+    }
+  }
+  /**
+   * aggregates the pending tasks, tasks of the groups below groupCount are counted in groupCounts
+   * (0 holds the tasks without a group)
+   */
+  Snapshot snapshot(unsigned int* groupCounts = NULL, GroupId groupCount = 0) const;
 
   void clear();
   Group group();
+  /**
+   * token bucket holding up to capacity tokens, refilled with one token every interval
+   */
+  RateLimiter rateLimiter(unsigned int capacity, Interval interval);
+
+  /**
+   * runs the callable once no trigger happened during the last wait time
+   */
+  template<typename Callable>
+  Debounce<typename TinyDecay<Callable>::type> debounce(Interval wait, Callable&& callable) {
+    return Debounce<typename TinyDecay<Callable>::type>(*this, wait, tinyForward<Callable>(callable));
+  }
 
+  /**
+   * runs the callable at most once every wait time, triggers inside the window are merged into one trailing run
+   */
   template<typename Callable>
-  TinyScheduler& timeout(unsigned long delta, Callable callable) {
-    unsigned long time =  this->timeProvider();
-    unsigned long when = time + delta;
-    bool overflow = when < time;
-    this->addNode((new BaseNode<Callable>(when, callable))->withOverflow(overflow));
+  Throttle<typename TinyDecay<Callable>::type> throttle(Interval wait, Callable&& callable) {
+    return Throttle<typename TinyDecay<Callable>::type>(*this, wait, tinyForward<Callable>(callable));
+  }
+
+  /**
+   * runs a batch of due nodes and returns once they have all run, e.g. on a thread pool
+   * (see TinyThreadPool.h). Nodes are chained with getNext() and run with dispatch()
+   */
+  class Executor {
+  public:
+    virtual void execute(Node* first) = 0;
+  };
+
+  /**
+   * independent tasks due at the same tick are run together by the executor,
+   * the other ones keep running one by one from tick()
+   */
+  BasicTinyScheduler& withExecutor(Executor* executor);
+  /**
+   * marks the last added task as independent from the others, so it can run in parallel.
+   * Its callable may run on another thread and must not call back into the scheduler
+   * (adding, cancelling or re-arming tasks), nothing locks it
+   */
+  BasicTinyScheduler& independent();
+
+  /**
+   * what happens to a new task once the scheduler holds its maximum number of tasks
+   */
+  enum Admission {
+    // the new task is rejected
+    ADMIT_REJECT,
+    // the one-shot task added first is dropped, or the new task is rejected if there is none.
+    // The order is kept in 16 bits, a task outliving 32768 newer ones may look newer
+    ADMIT_DROP_OLDEST,
+    // the lowest priority task (latest deadline first) is dropped if it is lower than the new one,
+    // otherwise the new task is rejected
+    ADMIT_DROP_LOWEST_PRIORITY
+  };
+  /**
+   * bounds the number of tasks owned by the scheduler, 0 is unbounded.
+   * A rejected call leaves last() NULL, addNode() returns NULL
+   */
+  BasicTinyScheduler& withCapacity(unsigned int capacity, Admission admission = ADMIT_REJECT);
+  /**
+   * priority (0 to 15) of the next task added, for ADMIT_DROP_LOWEST_PRIORITY
+   */
+  BasicTinyScheduler& priority(uint8_t priority);
+  unsigned long getRejected() const;
+  unsigned long getDropped() const;
+
+  /**
+   * wall clock used by cron tasks, without it cron counts from boot time
+   */
+  BasicTinyScheduler& withWallClock(WallClock wallClock);
+  /**
+   * spreads the first run of tasks added with every(interval, ...) over their interval,
+   * so tasks registered together do not fire as one burst
+   */
+  BasicTinyScheduler& withPhaseSpreading(PhaseSpreading spreading);
+
+  /**
+   * callables are taken by forwarding reference and moved or copied once into their node
+   */
+  template<typename Callable>
+  BasicTinyScheduler& timeout(Time delta, Callable&& callable) {
+    this->schedule(this->timeoutNode(delta, tinyForward<Callable>(callable)), 0);
     return *this;
   }
 
+  template<typename Callable>
+  BasicTinyScheduler& every(Interval interval, Callable&& callable) {
+    this->schedule(this->everyNode(this->firstInterval(interval), interval, tinyForward<Callable>(callable)), 0);
+    return *this;
+  }
 
   template<typename Callable>
-  TinyScheduler& every(unsigned long interval, Callable callable) {
-    unsigned long time =  this->timeProvider();
-    unsigned long when = time + interval;
-    bool overflow = when < time;
-    this->addNode((new PeriodicNode<Callable>(when, interval, callable))->withOverflow(overflow));
+  BasicTinyScheduler& every(Time firstInterval, Interval interval, Callable&& callable) {
+    this->schedule(this->everyNode(firstInterval, interval, tinyForward<Callable>(callable)), 0);
     return *this;
   }
 
   template<typename Callable>
-  TinyScheduler& every(unsigned long firstInterval, unsigned long interval, Callable callable) {
-    unsigned long time =  this->timeProvider();
-    unsigned long when = time + firstInterval;
-    bool overflow = when < time;
-    this->addNode((new PeriodicNode<Callable>(when, interval, callable))->withOverflow(overflow));
+  BasicTinyScheduler& repeat(unsigned int times, Interval interval, Callable&& callable) {
+    this->schedule(this->repeatNode(times, interval, interval, tinyForward<Callable>(callable)), 0);
     return *this;
   }
 
+  typedef void (*SharedTask)();
+  /**
+   * like every(interval, task), but tasks added with the same interval and the same first run
+   * share one node that calls them in order, so the queue grows with the periods instead of the tasks.
+   * last() is the shared node, phase spreading does not apply
+   */
+  BasicTinyScheduler& everyShared(Interval interval, SharedTask task);
 
   template<typename Callable>
-  TinyScheduler& repeat(unsigned int times, unsigned long interval, Callable callable) {
-    if(times == 0) return *this;
-    unsigned long time =  this->timeProvider();
-    unsigned long when = time + interval;
-    bool overflow = when < time;
-    this->addNode((new RepeatableNode<Callable>(when, times, interval, callable))->withOverflow(overflow));
+  BasicTinyScheduler& repeat(unsigned int times, Time firstInterval,  Interval interval, Callable&& callable) {
+    this->schedule(this->repeatNode(times, firstInterval, interval, tinyForward<Callable>(callable)), 0);
     return *this;
   }
 
+  /**
+   * like timeout(), returning a TinyFuture other threads can poll or wait on for the result.
+   * The future state lives in the node, include TinyFuture.h to use it
+   */
+  template<typename Callable>
+  typename TinyAsync<BasicTinyScheduler, Callable>::Future timeoutAsync(Time delta, Callable&& callable) {
+    typedef TinyAsync<BasicTinyScheduler, Callable> Async;
+    Time time = this->timeProvider();
+    Time when = time + delta;
+    typename Async::Node* node = new typename Async::Node(when, tinyForward<Callable>(callable));
+    typename Async::Future future(node);
+    this->schedule(node->withOverflow(when < time), 0);
+    return future;
+  }
 
+  /**
+   * runs at the times matched by a "minute hour day-of-month month day-of-week" expression,
+   * invalid expressions are ignored.
+   * The gap between two runs must fit in the time provider range (~71 minutes for 32 bits micros)
+   */
   template<typename Callable>
-  TinyScheduler& repeat(unsigned int times, unsigned long firstInterval,  unsigned long interval, Callable callable) {
-    if(times == 0) return *this;
-    unsigned long time =  this->timeProvider();
-    unsigned long when = time + firstInterval;
-    bool overflow = when < time;
-    this->addNode((new RepeatableNode<Callable>(when, times, interval, callable))->withOverflow(overflow));
+  BasicTinyScheduler& cron(const char* expression, Callable&& callable) {
+    this->schedule(this->cronNode(expression, tinyForward<Callable>(callable)), 0);
+    return *this;
+  }
+
+  /**
+   * runs the callable delta after the last added task is done, it is only queued then.
+   * Timeouts are done after their run and repeat tasks after their last one
+   */
+  template<typename Callable>
+  BasicTinyScheduler& then(Time delta, Callable&& callable) {
+    this->thenNode(delta, tinyForward<Callable>(callable), 0);
+    return *this;
+  }
+
+  /**
+   * runs the callable delta after all the predecessors are done, if one of them is
+   * cancelled instead the callable never runs.
+   * Predecessors are tasks taken from last() that must still be pending, a done task is freed.
+   * NULL ones are skipped. Each one can have a single continuation, if a predecessor already
+   * has one or is persistent the callable is rejected and last() is NULL
+   */
+  template<unsigned int Count, typename Callable>
+  BasicTinyScheduler& after(Node* (&predecessors)[Count], Time delta, Callable&& callable) {
+    static_assert(Count < 32, "at most 31 predecessors");
+    typedef typename TinyDecay<Callable>::type Type;
+    this->chain(predecessors, Count, new BaseNode<Type>(delta, tinyForward<Callable>(callable)));
     return *this;
   }
 
   class Node {
     public:
       Node();
-      Node(unsigned long when);
+      Node(Time when);
+      /**
+       * copies are not linked to any queue
+       */
+      Node(const Node& node);
       /**
        * returns true if it is done
        */
       virtual bool run() { return true;};
-      virtual ~Node() {};
+      /**
+       * returns false if the node has no interval
+       */
+      virtual bool setInterval(Interval interval) { return false; };
+      /**
+       * returns true if the node runs once, the ones ADMIT_DROP_OLDEST can drop
+       */
+      virtual bool isOneShot() const { return false; };
+      virtual ~Node() { this->remove(); };
+      /**
+       * called once the scheduler is done with a node it owns
+       */
+      virtual void dispose() { delete this; };
 
       bool isAfter(const Node& node) const;
-      bool isAfter(unsigned long delta) const;
-      bool isAfter(bool overflow, unsigned long delta) const;
+      bool isAfter(Time delta) const;
+      bool isAfter(bool overflow, Time delta) const;
       bool isBefore(const Node& node) const;
-      bool isBefore(unsigned long delta) const;
-      bool isBefore(bool overflow, unsigned long delta) const;
+      bool isBefore(Time delta) const;
+      bool isBefore(bool overflow, Time delta) const;
       bool isOverflow() const;
       bool hasNext() const;
-      unsigned long leftTime(unsigned long delta) const;
+      bool isLinked() const;
+      Time leftTime(Time delta) const;
 
       void setNext(Node* next);
+      /**
+       * unlinks the node from its queue
+       */
       void remove();
-      Node* withGroupId(unsigned long groupId);
+      Node* withGroupId(GroupId groupId);
       Node* withOverflow(bool overflow);
+      Node* withIndependent(bool independent);
+      Node* getNext() const;
+      /**
+       * runs the node from an executor, the scheduler reads the result once the batch is done
+       */
+      void dispatch();
+      /**
+       * returns true if the node waits for predecessors before being queued
+       */
+      bool isWaiting() const;
+      Time getWhen() const;
+      GroupId getGroupId() const;
 
 
       virtual void debug(Stream& stream) const;
     private:
 
-      friend TinyScheduler;
+      friend BasicTinyScheduler;
+      Node& operator=(const Node& node);
+      void linkAfter(Node* node);
       Node* next;
-      bool overflow = false;
-      unsigned long when;
-      unsigned long groupId = 0;
+      Node* prev;
+      Time when;
+      GroupId groupId;
+      bool overflow : 1;
+      /**
+       * persistent nodes belong to their owner, the scheduler unlinks them instead of deleting them
+       */
+      bool persistent : 1;
+      /**
+       * continuations are kept out of the queue until their waiting predecessors are done,
+       * with their delay in when. They are dropped if a predecessor is cancelled
+       */
+      bool abandoned : 1;
+      uint8_t waiting : 5;
+      /**
+       * independent nodes may run in parallel, finished holds the result of dispatch()
+       */
+      bool independent : 1;
+      bool finished : 1;
+      uint8_t priority : 4;
+      // admission order for ADMIT_DROP_OLDEST, compared with a wrap safe difference
+      uint16_t sequence;
+      Node* successor;
   };
 
 
@@ -144,7 +481,12 @@ public:
         return true;
       }
 
-      BaseNode(unsigned long when, Callable callable) : Node(when), callable(callable) {
+      bool isOneShot() const {
+        return true;
+      }
+
+      template<typename Argument>
+      BaseNode(Time when, Argument&& callable) : Node(when), callable(tinyForward<Argument>(callable)) {
 
       }
   };
@@ -153,29 +495,112 @@ public:
   class PeriodicNode: public Node {
     protected:
       Callable callable;
-      unsigned long interval;
+      Interval interval;
     public:
 
       bool run() {
         this->callable();
-        unsigned long oldWhen = this->when;
+        Time oldWhen = this->when;
         this->when += this->interval;
         this->overflow = this->when < oldWhen;
         return false;
       }
 
-      PeriodicNode(unsigned long when, unsigned long interval, Callable callable) : Node(when), callable(callable), interval(interval) {
+      template<typename Argument>
+      PeriodicNode(Time when, Interval interval, Argument&& callable) : Node(when), callable(tinyForward<Argument>(callable)), interval(interval) {
+
+      }
 
+      bool setInterval(Interval interval) {
+        this->interval = interval;
+        return true;
       }
 
       void debug(Stream& stream) const {
-          stream.print("RepeatableNode {");
+          stream.print("PeriodicNode {");
           stream.print(" .groupId=");
-          stream.print(this->groupId);
+          stream.print((unsigned long) this->groupId);
+          stream.print(" .when=");
+          stream.print((unsigned long) this->when);
+          stream.print(" .interval=");
+          stream.print((unsigned long) this->interval);
+          stream.print(" .overflow=");
+          stream.print(this->overflow);
+          stream.print(" }");
+      }
+  };
+
+  /**
+   * periodic node running a contiguous array of tasks, registered in the scheduler
+   * until it is disposed so everyShared() can find it
+   */
+  class SharedBucket: public Node {
+    protected:
+      BasicTinyScheduler& scheduler;
+      Interval interval;
+      SharedTask* tasks;
+      unsigned int size;
+      unsigned int capacity;
+    public:
+      SharedBucket* nextBucket;
+
+      bool run() {
+        // a task may add to the bucket, the array can move
+        for(unsigned int i = 0; i < this->size; i++) {
+          this->tasks[i]();
+        }
+        Time oldWhen = this->when;
+        this->when += this->interval;
+        this->overflow = this->when < oldWhen;
+        return false;
+      }
+
+      SharedBucket(BasicTinyScheduler& scheduler, Time when, Interval interval) : Node(when), scheduler(scheduler), interval(interval), tasks(NULL), size(0), capacity(0), nextBucket(NULL) {
+
+      }
+
+      ~SharedBucket() {
+        delete[] this->tasks;
+      }
+
+      bool matches(Time when, Interval interval, bool overflow) const {
+        return this->when == when && this->interval == interval && this->overflow == overflow;
+      }
+
+      void add(SharedTask task) {
+        if(this->size == this->capacity) {
+          this->capacity = this->capacity == 0 ? 4 : this->capacity * 2;
+          SharedTask* tasks = new SharedTask[this->capacity];
+          for(unsigned int i = 0; i < this->size; i++) {
+            tasks[i] = this->tasks[i];
+          }
+          delete[] this->tasks;
+          this->tasks = tasks;
+        }
+        this->tasks[this->size++] = task;
+      }
+
+      unsigned int count() const {
+        return this->size;
+      }
+
+      void dispose() {
+        SharedBucket** link = &this->scheduler.buckets;
+        while(*link != this) {
+          link = &(*link)->nextBucket;
+        }
+        *link = this->nextBucket;
+        delete this;
+      }
+
+      void debug(Stream& stream) const {
+          stream.print("SharedBucket {");
           stream.print(" .when=");
-          stream.print(this->when);
+          stream.print((unsigned long) this->when);
           stream.print(" .interval=");
-          stream.print(this->interval);
+          stream.print((unsigned long) this->interval);
+          stream.print(" .tasks=");
+          stream.print(this->size);
           stream.print(" .overflow=");
           stream.print(this->overflow);
           stream.print(" }");
@@ -186,33 +611,86 @@ public:
   class RepeatableNode: public Node {
     protected:
       Callable callable;
+      Interval interval;
       unsigned int times;
-      unsigned long interval;
     public:
 
       bool run() {
         this->times -= 1;
         this->callable();
-        unsigned long oldWhen = this->when;
+        Time oldWhen = this->when;
         this->when += this->interval;
         this->overflow = this->when < oldWhen;
         return this->times == 0;
       }
 
-      RepeatableNode(unsigned long when, unsigned int times, unsigned long interval, Callable callable) : Node(when),  times(times), callable(callable), interval(interval) {
+      template<typename Argument>
+      RepeatableNode(Time when, unsigned int times, Interval interval, Argument&& callable) : Node(when), callable(tinyForward<Argument>(callable)), interval(interval), times(times) {
+
+      }
 
+      bool setInterval(Interval interval) {
+        this->interval = interval;
+        return true;
       }
 
       void debug(Stream& stream) const {
           stream.print("RepeatableNode {");
           stream.print(" .groupId=");
-          stream.print(this->groupId);
+          stream.print((unsigned long) this->groupId);
           stream.print(" .when=");
-          stream.print(this->when);
+          stream.print((unsigned long) this->when);
           stream.print(" .times=");
           stream.print(this->times);
           stream.print(" .interval=");
-          stream.print(this->interval);
+          stream.print((unsigned long) this->interval);
+          stream.print(" .overflow=");
+          stream.print(this->overflow);
+          stream.print(" }");
+      }
+  };
+
+
+
+  template<typename Callable>
+  class CronNode: public Node {
+    protected:
+      BasicTinyScheduler& scheduler;
+      Callable callable;
+      Cron expression;
+      unsigned long at;
+    public:
+
+      /**
+       * each run is placed from the wall clock again, so drift between the clocks does not add up
+       */
+      bool run() {
+        this->callable();
+        Time when;
+        bool overflow;
+        if(!this->scheduler.cronDeadline(this->expression, this->at, this->at, when, overflow)) {
+          return true;
+        }
+        this->when = when;
+        this->overflow = overflow;
+        return false;
+      }
+
+      template<typename Argument>
+      CronNode(BasicTinyScheduler& scheduler, Time when, const Cron& expression, unsigned long at, Argument&& callable) : Node(when), scheduler(scheduler), callable(tinyForward<Argument>(callable)), expression(expression), at(at) {
+
+      }
+
+      void debug(Stream& stream) const {
+          stream.print("CronNode {");
+          stream.print(" .groupId=");
+          stream.print((unsigned long) this->groupId);
+          stream.print(" .when=");
+          stream.print((unsigned long) this->when);
+          stream.print(" .at=");
+          stream.print((unsigned long) this->at);
+          stream.print(" .expression=");
+          this->expression.debug(stream);
           stream.print(" .overflow=");
           stream.print(this->overflow);
           stream.print(" }");
@@ -220,111 +698,863 @@ public:
   };
 
 
+  template<typename Callable>
+  class Debounce: public Node {
+    protected:
+      BasicTinyScheduler& scheduler;
+      Callable callable;
+      Interval wait;
+    public:
+
+      bool run() {
+        this->callable();
+        // triggered again by the callable
+        return !this->isLinked();
+      }
+
+      /**
+       * moves the pending run to wait time from now
+       */
+      void trigger() {
+        Time time = this->scheduler.timeProvider();
+        Time when = time + this->wait;
+        this->scheduler.moveNode(this, when, when < time);
+      }
+
+      void cancel() {
+        this->remove();
+      }
+
+      bool isPending() const {
+        return this->isLinked();
+      }
+
+      template<typename Argument>
+      Debounce(BasicTinyScheduler& scheduler, Interval wait, Argument&& callable) : scheduler(scheduler), callable(tinyForward<Argument>(callable)), wait(wait) {
+        this->persistent = true;
+      }
+  };
+
+  template<typename Callable>
+  class Throttle: public Node {
+    protected:
+      BasicTinyScheduler& scheduler;
+      Callable callable;
+      Interval wait;
+      bool triggered = false;
+      bool running = false;
+    public:
+
+      /**
+       * closes the window, running the trailing call if there was any trigger inside it
+       */
+      bool run() {
+        if(!this->triggered) {
+          return true;
+        }
+        this->triggered = false;
+        // triggers from the callable fall in the window it opens
+        this->running = true;
+        this->callable();
+        this->running = false;
+        Time oldWhen = this->when;
+        this->when += this->wait;
+        this->overflow = this->when < oldWhen;
+        return false;
+      }
+
+      /**
+       * runs the callable now if there is no open window
+       */
+      void trigger() {
+        if(this->isLinked() || this->running) {
+          this->triggered = true;
+          return;
+        }
+        // the window is open before the callable runs, so it can trigger again
+        Time time = this->scheduler.timeProvider();
+        Time when = time + this->wait;
+        this->scheduler.moveNode(this, when, when < time);
+        this->callable();
+      }
+
+      void cancel() {
+        this->triggered = false;
+        this->remove();
+      }
+
+      template<typename Argument>
+      Throttle(BasicTinyScheduler& scheduler, Interval wait, Argument&& callable) : scheduler(scheduler), callable(tinyForward<Argument>(callable)), wait(wait) {
+        this->persistent = true;
+      }
+  };
+
+
+  /**
+   * task stored by the application, the scheduler links it in place so arming
+   * and disarming it never allocates. It is disarmed when destroyed.
+   */
+  template<typename Callable>
+  class BasicTask: public Node {
+    protected:
+      Callable callable;
+      Interval interval;
+      bool periodic;
+    public:
+
+      bool run() {
+        this->callable();
+        // the callable armed it again, the new deadline stands
+        if(this->isLinked()) {
+          return false;
+        }
+        if(!this->periodic) {
+          return true;
+        }
+        Time oldWhen = this->when;
+        this->when += this->interval;
+        this->overflow = this->when < oldWhen;
+        return false;
+      }
+
+      bool setInterval(Interval interval) {
+        this->interval = interval;
+        return this->periodic;
+      }
+
+      bool isArmed() const {
+        return this->isLinked();
+      }
+
+      // not a forwarding template, which would be picked over the copy constructor
+      BasicTask(const Callable& callable) : callable(callable), interval(0), periodic(false), scheduler(NULL) {
+        this->persistent = true;
+      }
+
+      BasicTask(Callable&& callable) : callable(tinyForward<Callable>(callable)), interval(0), periodic(false), scheduler(NULL) {
+        this->persistent = true;
+      }
+
+      ~BasicTask() {
+        if(this->scheduler != NULL && this->scheduler->lastNode == this) {
+          this->scheduler->lastNode = NULL;
+        }
+      }
+
+    private:
+      friend BasicTinyScheduler;
+      // the last one that armed it, so last() does not outlive the task
+      BasicTinyScheduler* scheduler;
+  };
+
+  class Task: public BasicTask<void (*)()> {
+    public:
+      Task(void (*callback)()) : BasicTask<void (*)()>(callback) {
+
+      }
+  };
+
+
+  struct Snapshot {
+    unsigned int count;
+    /**
+     * tasks whose deadline has passed but have not run yet
+     */
+    unsigned int overdue;
+    /**
+     * time left until the earliest and the latest deadline, 0 if overdue
+     */
+    Time earliest;
+    Time latest;
+    unsigned int* groupCounts;
+    GroupId groupCount;
+
+    /**
+     * {"count":2,"overdue":0,"earliest":5,"latest":10,"groups":[1,1]}
+     */
+    void toJson(Print& stream) const;
+  };
+
   class Group {
   public:
     void clear();
 
     template<typename Callable>
-    Group& timeout(unsigned long delta, Callable callable) {
-      unsigned long time =  this->scheduler.timeProvider();
-      unsigned long when = time + delta;
-      bool overflow = when < time;
-      this->scheduler.addNode((new BaseNode<Callable>(when, callable))->withGroupId(this->id)->withOverflow(overflow));
+    Group& timeout(Time delta, Callable&& callable) {
+      this->scheduler.schedule(this->scheduler.timeoutNode(delta, tinyForward<Callable>(callable)), this->id);
       return *this;
     }
 
-
     template<typename Callable>
-    Group& every(unsigned long interval, Callable callable) {
-      unsigned long time =  this->scheduler.timeProvider();
-      unsigned long when = time + interval;
-      bool overflow = when < time;
-      this->scheduler.addNode((new PeriodicNode<Callable>(when, interval, callable))->withGroupId(this->id)->withOverflow(overflow));
+    Group& every(Interval interval, Callable&& callable) {
+      this->scheduler.schedule(this->scheduler.everyNode(this->scheduler.firstInterval(interval), interval, tinyForward<Callable>(callable)), this->id);
       return *this;
     }
 
     template<typename Callable>
-    Group& every(unsigned long firstInterval, unsigned long interval, Callable callable) {
-      unsigned long time =  this->scheduler.timeProvider();
-      unsigned long when = time + firstInterval;
-      bool overflow = when < time;
-      this->scheduler.addNode((new PeriodicNode<Callable>(when, interval, callable))->withGroupId(this->id)->withOverflow(overflow));
+    Group& every(Time firstInterval, Interval interval, Callable&& callable) {
+      this->scheduler.schedule(this->scheduler.everyNode(firstInterval, interval, tinyForward<Callable>(callable)), this->id);
       return *this;
     }
 
+    template<typename Callable>
+    Group& repeat(unsigned int times, Interval interval, Callable&& callable) {
+      this->scheduler.schedule(this->scheduler.repeatNode(times, interval, interval, tinyForward<Callable>(callable)), this->id);
+      return *this;
+    }
 
     template<typename Callable>
-    Group& repeat(unsigned int times, unsigned long interval, Callable callable) {
-      if(times == 0) return *this;
-      unsigned long time =  this->scheduler.timeProvider();
-      unsigned long when = time + interval;
-      bool overflow = when < time;
-      this->scheduler.addNode((new RepeatableNode<Callable>(when, times, interval, callable))->withGroupId(this->id)->withOverflow(overflow));
+    Group& repeat(unsigned int times, Time firstInterval,  Interval interval, Callable&& callable) {
+      this->scheduler.schedule(this->scheduler.repeatNode(times, firstInterval, interval, tinyForward<Callable>(callable)), this->id);
       return *this;
     }
 
+    template<typename Callable>
+    Group& cron(const char* expression, Callable&& callable) {
+      this->scheduler.schedule(this->scheduler.cronNode(expression, tinyForward<Callable>(callable)), this->id);
+      return *this;
+    }
 
     template<typename Callable>
-    Group& repeat(unsigned int times, unsigned long firstInterval,  unsigned long interval, Callable callable) {
-      if(times == 0) return *this;
-      unsigned long time =  this->scheduler.timeProvider();
-      unsigned long when = time + firstInterval;
-      bool overflow = when < time;
-      this->scheduler.addNode((new RepeatableNode<Callable>(when, times, interval, callable))->withGroupId(this->id)->withOverflow(overflow));
+    Group& then(Time delta, Callable&& callable) {
+      this->scheduler.thenNode(delta, tinyForward<Callable>(callable), this->id);
       return *this;
     }
 
   private:
-    friend TinyScheduler;
-    Group(TinyScheduler& scheduler, unsigned long id);
-    unsigned long id;
-    TinyScheduler& scheduler;
+    friend BasicTinyScheduler;
+    Group(BasicTinyScheduler& scheduler, GroupId id);
+    GroupId id;
+    BasicTinyScheduler& scheduler;
   };
 
-  Node* addNode(Node* newNode);
+  /**
+   * Tokens are refilled lazily from the time provider when they are requested,
+   * so a rate limiter only uses the queue for callables waiting on a token.
+   */
+  class RateLimiter {
+  public:
+    /**
+     * takes a token if there is one available
+     */
+    bool tryAcquire();
+    /**
+     * runs the callable now if there is a token available, otherwise reserves
+     * the next token and schedules the callable for when it is refilled.
+     * returns true if the callable was run right away
+     */
+    template<typename Callable>
+    bool acquire(Callable&& callable) {
+      if(this->tryAcquire()) {
+        callable();
+        return true;
+      }
+      this->tokens -= 1;
+      Time elapsed = this->scheduler.timeProvider() - this->last;
+      this->scheduler.timeout((Time) -this->tokens * this->interval - elapsed, tinyForward<Callable>(callable));
+      return false;
+    }
+    long available();
 
-private:
-  friend Group;
-  Node head;
-  TimeProvider timeProvider;
-  Delay delay;
-  unsigned long lastTick = 0;
-  unsigned long nextGroupId = 1;
+  private:
+    friend BasicTinyScheduler;
+    RateLimiter(BasicTinyScheduler& scheduler, unsigned int capacity, Interval interval);
+    void refill();
+    BasicTinyScheduler& scheduler;
+    long tokens;
+    unsigned int capacity;
+    Interval interval;
+    Time last;
+  };
 
-  void handleNode(Node* node);
-  void handleOverflow();
-  void clearGroup(unsigned long groupId);
+  Node* addNode(Node* newNode);
 
-  unsigned long getNextGroupId() {
-    this->nextGroupId = max(1, this->nextGroupId);
-    return this->nextGroupId++;
+  /**
+   * runs the task once after delta, an armed task is moved instead
+   */
+  template<typename Callable>
+  BasicTinyScheduler& arm(BasicTask<Callable>& task, Time delta) {
+    Time time = this->timeProvider();
+    Time when = time + delta;
+    task.periodic = false;
+    this->moveNode(&task, when, when < time);
+    task.scheduler = this;
+    this->lastNode = &task;
+    return *this;
   }
 
-};
+  /**
+   * runs the task every interval after delta, an armed task is moved instead
+   */
+  template<typename Callable>
+  BasicTinyScheduler& arm(BasicTask<Callable>& task, Time delta, Interval interval) {
+    Time time = this->timeProvider();
+    Time when = time + delta;
+    task.periodic = true;
+    task.interval = interval;
+    this->moveNode(&task, when, when < time);
+    task.scheduler = this;
+    this->lastNode = &task;
+    return *this;
+  }
 
-/*********** IMPLEMENTATION DETAIL  - Originally in TinyScheduler.cc ************/
+  /**
+   * returns false if the task was not armed
+   */
+  template<typename Callable>
+  bool disarm(BasicTask<Callable>& task) {
+    bool armed = task.isArmed();
+    if(armed) {
+      this->hooks().onCancel(task);
+    }
+    task.remove();
+    if(this->lastNode == &task) {
+      this->lastNode = NULL;
+    }
+    return armed;
+  }
 
-void usDelay(unsigned long us) {
-  delayMicroseconds(us);
+  /**
+   * the task added by the last scheduling call, NULL once it is done
+   */
+  Node* last() const;
+
+  /**
+   * moves a pending task to delta from now, returns false if it is not pending.
+   * The node must still be allocated: one from last() is freed once it is done, so it is
+   * only safe before the next tick. A Task stays valid after its runs, see the overloads below
+   */
+  bool reschedule(Node* node, Time delta);
+  /**
+   * delays a pending task by delta, returns false if it is not pending (see reschedule())
+   */
+  bool postpone(Node* node, Time delta);
+  /**
+   * changes the interval of a pending periodic or repeatable task, starting after its next run
+   * (see reschedule())
+   */
+  bool setInterval(Node* node, Interval interval);
+
+  /**
+   * returns false if the task is not armed, unlike arm()
+   */
+  template<typename Callable>
+  bool reschedule(BasicTask<Callable>& task, Time delta) {
+    return this->reschedule(static_cast<Node*>(&task), delta);
+  }
+
+  template<typename Callable>
+  bool postpone(BasicTask<Callable>& task, Time delta) {
+    return this->postpone(static_cast<Node*>(&task), delta);
+  }
+
+  /**
+   * only applies to a periodic task, starting after its next run
+   */
+  template<typename Callable>
+  bool setInterval(BasicTask<Callable>& task, Interval interval) {
+    return this->setInterval(static_cast<Node*>(&task), interval);
+  }
+
+private:
+  friend Group;
+  friend RateLimiter;
+  Node head;
+  /**
+   * nodes re-armed by the current tick, merged back into the queue once the due ones have run
+   */
+  Node rearmed;
+  /**
+   * independent due nodes waiting for the executor, chained through next only so they
+   * do not look linked while they run
+   */
+  Node batch;
+  Executor* executor = NULL;
+  Node* lastNode = NULL;
+  SharedBucket* buckets = NULL;
+  TimeProvider timeProvider;
+  Delay delay;
+  WallClock wallClock = NULL;
+  unsigned long resolution;
+  Time lastTick = 0;
+  GroupId nextGroupId = 1;
+  PhaseSpreading spreading = SPREAD_NONE;
+  unsigned int capacity = 0;
+  Admission admission = ADMIT_REJECT;
+  unsigned int size = 0;
+  uint8_t nextPriority = 0;
+  unsigned long rejected = 0;
+  unsigned long dropped = 0;
+  uint16_t admitted = 0;
+  uint32_t spreadState = 0;
+
+  void handleNode(Node* node);
+  void finishNode(Node* node, bool done);
+  void runBatch();
+  void defer(Node* node);
+  void mergeRearmed();
+  bool drain(Time delta);
+  void handleOverflow();
+  void moveNode(Node* node, Time when, bool overflow);
+  Node* insertNode(Node* newNode);
+  void chain(Node** predecessors, unsigned int count, Node* node);
+  void resolve(Node* predecessor, bool done);
+  Interval firstInterval(Interval interval);
+  void release(Node* node);
+  bool admit(Node* node, bool evict);
+  void clearGroup(GroupId groupId);
+
+  unsigned long now() const {
+    if(this->wallClock != NULL) {
+      return this->wallClock();
+    }
+    return this->timeProvider() / this->resolution;
+  }
+
+  /**
+   * adds a node built by the helpers below, NULL clears last() so then() has nothing to follow
+   */
+  void schedule(Node* node, GroupId groupId) {
+    if(node == NULL) {
+      this->lastNode = NULL;
+      return;
+    }
+    this->addNode(node->withGroupId(groupId));
+  }
+
+  template<typename Callable>
+  Node* timeoutNode(Time delta, Callable&& callable) {
+    typedef typename TinyDecay<Callable>::type Type;
+    Time time = this->timeProvider();
+    Time when = time + delta;
+    bool overflow = when < time;
+    return (new BaseNode<Type>(when, tinyForward<Callable>(callable)))->withOverflow(overflow);
+  }
+
+  template<typename Callable>
+  Node* everyNode(Time firstInterval, Interval interval, Callable&& callable) {
+    typedef typename TinyDecay<Callable>::type Type;
+    Time time = this->timeProvider();
+    Time when = time + firstInterval;
+    bool overflow = when < time;
+    return (new PeriodicNode<Type>(when, interval, tinyForward<Callable>(callable)))->withOverflow(overflow);
+  }
+
+  template<typename Callable>
+  Node* repeatNode(unsigned int times, Time firstInterval, Interval interval, Callable&& callable) {
+    typedef typename TinyDecay<Callable>::type Type;
+    if(times == 0) {
+      return NULL;
+    }
+    Time time = this->timeProvider();
+    Time when = time + firstInterval;
+    bool overflow = when < time;
+    return (new RepeatableNode<Type>(when, times, interval, tinyForward<Callable>(callable)))->withOverflow(overflow);
+  }
+
+  template<typename Callable>
+  void thenNode(Time delta, Callable&& callable, GroupId groupId) {
+    typedef typename TinyDecay<Callable>::type Type;
+    Node* predecessors[] = { this->lastNode };
+    if(this->lastNode != NULL) {
+      this->chain(predecessors, 1, (new BaseNode<Type>(delta, tinyForward<Callable>(callable)))->withGroupId(groupId));
+    }
+  }
+
+  template<typename Callable>
+  Node* cronNode(const char* expression, Callable&& callable) {
+    typedef typename TinyDecay<Callable>::type Type;
+    Cron cron;
+    unsigned long at;
+    Time when;
+    bool overflow;
+    if(!cron.parse(expression) || !this->cronDeadline(cron, 0, at, when, overflow)) {
+      return NULL;
+    }
+    return (new CronNode<Type>(*this, when, cron, at, tinyForward<Callable>(callable)))->withOverflow(overflow);
+  }
+
+  /**
+   * first match of the expression after both the wall clock and the given epoch, placed
+   * on the time provider from the wall clock read now. Returns false if there is none
+   */
+  bool cronDeadline(const Cron& cron, unsigned long after, unsigned long& at, Time& when, bool& overflow) {
+    Time time = this->timeProvider();
+    unsigned long wall = this->now();
+    // the time provider may run ahead of the wall clock, the same match never runs twice
+    unsigned long next = cron.next(after > wall ? after : wall);
+    if(next == 0) {
+      return false;
+    }
+    at = next;
+    when = time + (next - wall) * this->resolution;
+    if(this->wallClock == NULL) {
+      when -= time % this->resolution;
+    }
+    overflow = when < time;
+    return true;
+  }
+
+  GroupId getNextGroupId() {
+    this->nextGroupId = max((GroupId) 1, this->nextGroupId);
+    return this->nextGroupId++;
+  }
+
+};
+
+typedef BasicTinyScheduler<> TinyScheduler;
+
+inline unsigned long tickEach() {
+  return (unsigned long) -1;
+}
+
+template<typename Scheduler, typename... Schedulers>
+unsigned long tickEach(Scheduler& scheduler, Schedulers&... schedulers) {
+  unsigned long wait = scheduler.toMicros(scheduler.tick());
+  if(scheduler.isEmpty()) {
+    wait = (unsigned long) -1;
+  }
+  const unsigned long others = tickEach(schedulers...);
+  return others < wait ? others : wait;
+}
+
+/**
+ * ticks every scheduler, returning the microseconds left until the earliest deadline
+ * or 0 if there is nothing pending
+ */
+template<typename... Schedulers>
+unsigned long tickAll(Schedulers&... schedulers) {
+  tickEach(schedulers...);
+  // the tasks of a scheduler delay the other ones, their waits are read again afterwards
+  unsigned long wait = tickEach(schedulers...);
+  return wait == (unsigned long) -1 ? 0 : wait;
 }
 
-TinyScheduler::TinyScheduler(TimeProvider timeProvider, Delay delay) : timeProvider(timeProvider), delay(delay) {
+inline bool isEachEmpty() {
+  return true;
+}
 
+template<typename Scheduler, typename... Schedulers>
+bool isEachEmpty(const Scheduler& scheduler, const Schedulers&... schedulers) {
+  return scheduler.isEmpty() && isEachEmpty(schedulers...);
 }
 
-TinyScheduler::~TinyScheduler() {
-  TinyScheduler::Node* node = this->head.next;
-  while(node != NULL) {
-    auto next = node->next;
-    delete node;
-    node = next;
+/**
+ * runs several schedulers from one thread, sleeping once until the earliest deadline
+ * with ::delay() and usDelay()
+ */
+template<typename... Schedulers>
+void loopAll(Schedulers&... schedulers) {
+  while(!isEachEmpty(schedulers...)) {
+    const unsigned long wait = tickAll(schedulers...);
+    if(wait >= 1000) {
+      ::delay(wait / 1000);
+    }
+    if(wait % 1000 != 0) {
+      usDelay(wait % 1000);
+    }
   }
 }
 
-void TinyScheduler::debug(Stream& stream) const {
+/*********** IMPLEMENTATION DETAIL  - Originally in TinyScheduler.cc ************/
+
+void usDelay(unsigned long us) {
+  delayMicroseconds(us);
+}
+
+// ---- CRON -----
+
+TinyCron::TinyCron(): minutes(0), hours(0), days(0), months(0), weekdays(0), anyDay(true), anyWeekday(true) {
+
+}
+
+bool TinyCron::parse(const char* expression) {
+  uint64_t minutes, hours, days, months, weekdays;
+  bool any;
+  const char* cursor = expression;
+  if(!parseField(cursor, minutes, 0, 59, any)) return false;
+  if(!parseField(cursor, hours, 0, 23, any)) return false;
+  if(!parseField(cursor, days, 1, 31, this->anyDay)) return false;
+  if(!parseField(cursor, months, 1, 12, any)) return false;
+  if(!parseField(cursor, weekdays, 0, 7, this->anyWeekday)) return false;
+  while(*cursor == ' ' || *cursor == '\t') cursor++;
+  if(*cursor != '\0') return false;
+  // sunday can be written both as 0 and 7
+  weekdays = (weekdays | (weekdays >> 7)) & 0x7F;
+  this->minutes = minutes;
+  this->hours = hours;
+  this->days = days;
+  this->months = months;
+  this->weekdays = weekdays;
+  return true;
+}
+
+unsigned long TinyCron::next(unsigned long epoch) const {
+  unsigned long minute = epoch / 60 + 1;
+  unsigned long day = minute / 1440;
+  unsigned int hour = (minute % 1440) / 60;
+  minute = minute % 60;
+  unsigned int year, month, dayOfMonth;
+  fromDays(day, year, month, dayOfMonth);
+  // a valid expression matches at least once every 4 years (29th of february)
+  const unsigned int lastYear = year + 5;
+  while(year <= lastYear) {
+    if(!((this->months >> month) & 1)) {
+      int nextMonth = nextBit(this->months, month + 1);
+      if(nextMonth < 0) {
+        year += 1;
+        nextMonth = nextBit(this->months, 1);
+      }
+      month = nextMonth;
+      dayOfMonth = 1;
+      day = toDays(year, month, dayOfMonth);
+      hour = 0;
+      minute = 0;
+      continue;
+    }
+    int nextHour = nextBit(this->hours, hour);
+    if(dayOfMonth > daysInMonth(year, month) || !this->matchesDay(day, dayOfMonth) || nextHour < 0) {
+      day += 1;
+      dayOfMonth += 1;
+      if(dayOfMonth > daysInMonth(year, month)) {
+        dayOfMonth = 1;
+        month += 1;
+        if(month > 12) {
+          month = 1;
+          year += 1;
+        }
+      }
+      hour = 0;
+      minute = 0;
+      continue;
+    }
+    if((unsigned int) nextHour != hour) {
+      hour = nextHour;
+      minute = 0;
+    }
+    int nextMinute = nextBit(this->minutes, minute);
+    if(nextMinute < 0) {
+      // an hour past 23 has no bit set, so the next iteration moves to the next day
+      hour += 1;
+      minute = 0;
+      continue;
+    }
+    return ((day * 24 + hour) * 60 + nextMinute) * 60;
+  }
+  return 0;
+}
+
+bool TinyCron::matchesDay(unsigned long day, unsigned int dayOfMonth) const {
+  bool matchesDayOfMonth = (this->days >> dayOfMonth) & 1;
+  // 1970-01-01 was a thursday
+  bool matchesWeekday = (this->weekdays >> ((day + 4) % 7)) & 1;
+  if(!this->anyDay && !this->anyWeekday) {
+    return matchesDayOfMonth || matchesWeekday;
+  }
+  return matchesDayOfMonth && matchesWeekday;
+}
+
+bool TinyCron::parseField(const char*& cursor, uint64_t& bits, unsigned int low, unsigned int high, bool& any) {
+  bits = 0;
+  any = false;
+  while(*cursor == ' ' || *cursor == '\t') cursor++;
+  do {
+    unsigned int first = low;
+    unsigned int last = high;
+    unsigned int step = 1;
+    bool valid = true;
+    if(*cursor == ',') cursor++;
+    if(*cursor == '*') {
+      cursor++;
+      any = *cursor != '/';
+    }
+    else {
+      first = last = parseNumber(cursor, valid);
+      if(*cursor == '-') {
+        cursor++;
+        last = parseNumber(cursor, valid);
+      }
+    }
+    if(*cursor == '/') {
+      cursor++;
+      step = parseNumber(cursor, valid);
+      if(first == last) last = high;
+    }
+    if(!valid || step == 0 || first < low || last > high || first > last) {
+      return false;
+    }
+    for(unsigned int value = first; value <= last; value += step) {
+      bits |= (uint64_t) 1 << value;
+    }
+  } while(*cursor == ',');
+  return *cursor == ' ' || *cursor == '\t' || *cursor == '\0';
+}
+
+unsigned int TinyCron::parseNumber(const char*& cursor, bool& valid) {
+  if(*cursor < '0' || *cursor > '9') {
+    valid = false;
+    return 0;
+  }
+  unsigned int value = 0;
+  while(*cursor >= '0' && *cursor <= '9' && value < 100) {
+    value = value * 10 + (*cursor - '0');
+    cursor++;
+  }
+  return value;
+}
+
+int TinyCron::nextBit(uint64_t bits, unsigned int from) {
+  if(from >= 64) {
+    return -1;
+  }
+  bits >>= from;
+  if(bits == 0) {
+    return -1;
+  }
+  return from + __builtin_ctzll(bits);
+}
+
+// days since the epoch, see http://howardhinnant.github.io/date_algorithms.html
+unsigned long TinyCron::toDays(unsigned int year, unsigned int month, unsigned int day) {
+  unsigned long y = year - (month <= 2);
+  unsigned long era = y / 400;
+  unsigned long yearOfEra = y - era * 400;
+  unsigned long dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + dayOfEra - 719468;
+}
+
+void TinyCron::fromDays(unsigned long days, unsigned int& year, unsigned int& month, unsigned int& day) {
+  days += 719468;
+  unsigned long era = days / 146097;
+  unsigned long dayOfEra = days - era * 146097;
+  unsigned long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  unsigned long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  unsigned long shiftedMonth = (5 * dayOfYear + 2) / 153;
+  day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+  month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+  year = yearOfEra + era * 400 + (month <= 2);
+}
+
+unsigned int TinyCron::daysInMonth(unsigned int year, unsigned int month) {
+  if(month == 2) {
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return leap ? 29 : 28;
+  }
+  return (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
+void TinyCron::debug(Stream& stream) const {
+  stream.print("Cron {");
+  stream.print(" .minutes=");
+  stream.print((unsigned long) (this->minutes >> 32), HEX);
+  stream.print((unsigned long) this->minutes, HEX);
+  stream.print(" .hours=");
+  stream.print((unsigned long) this->hours, HEX);
+  stream.print(" .days=");
+  stream.print((unsigned long) this->days, HEX);
+  stream.print(" .months=");
+  stream.print((unsigned long) this->months, HEX);
+  stream.print(" .weekdays=");
+  stream.print((unsigned long) this->weekdays, HEX);
+  stream.print(" }");
+}
+
+#define TINY_SCHEDULER_TEMPLATE template<typename Time, typename Interval, typename GroupId, typename Hooks>
+#define TINY_SCHEDULER BasicTinyScheduler<Time, Interval, GroupId, Hooks>
+
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::BasicTinyScheduler(TimeProvider timeProvider, Delay delay, unsigned long resolution) : timeProvider(timeProvider), delay(delay), resolution(resolution) {
+
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::withWallClock(WallClock wallClock) {
+  this->wallClock = wallClock;
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::withExecutor(Executor* executor) {
+  this->executor = executor;
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::everyShared(Interval interval, SharedTask task) {
+  Time time = this->timeProvider();
+  Time when = time + interval;
+  bool overflow = when < time;
+  SharedBucket* bucket = this->buckets;
+  while(bucket != NULL && !bucket->matches(when, interval, overflow)) {
+    bucket = bucket->nextBucket;
+  }
+  if(bucket == NULL) {
+    bucket = new SharedBucket(*this, when, interval);
+    bucket->withOverflow(overflow);
+    bucket->nextBucket = this->buckets;
+    this->buckets = bucket;
+    if(this->addNode(bucket) == NULL) {
+      return *this;
+    }
+  }
+  else {
+    this->nextPriority = 0;
+    this->lastNode = bucket;
+  }
+  bucket->add(task);
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::withCapacity(unsigned int capacity, Admission admission) {
+  this->capacity = capacity;
+  this->admission = admission;
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::priority(uint8_t priority) {
+  this->nextPriority = priority > 15 ? 15 : priority;
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+unsigned long TINY_SCHEDULER::getRejected() const {
+  return this->rejected;
+}
+
+TINY_SCHEDULER_TEMPLATE
+unsigned long TINY_SCHEDULER::getDropped() const {
+  return this->dropped;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::independent() {
+  if(this->lastNode != NULL) {
+    this->lastNode->withIndependent(true);
+  }
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER& TINY_SCHEDULER::withPhaseSpreading(PhaseSpreading spreading) {
+  this->spreading = spreading;
+  this->spreadState = spreading == SPREAD_RANDOM ? 2463534242UL ^ this->timeProvider() : 0;
+  return *this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::~BasicTinyScheduler() {
+  this->clear();
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::debug(Stream& stream) const {
   stream.println("TinyScheduler::debug");
   stream.println("TinyScheduler Tasks:");
-  TinyScheduler::Node* node = this->head.next;
+  Node* node = this->head.next;
   while (node != NULL) {
     stream.print("\t");
     node->debug(stream);
@@ -334,128 +1564,481 @@ void TinyScheduler::debug(Stream& stream) const {
   stream.println("-----");
 }
 
-bool TinyScheduler::isEmpty() const {
-  return !this->head.hasNext();
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Snapshot TINY_SCHEDULER::snapshot(unsigned int* groupCounts, GroupId groupCount) const {
+  Snapshot snapshot = { 0, 0, 0, 0, groupCounts, groupCount };
+  for(GroupId groupId = 0; groupId < groupCount; groupId++) {
+    groupCounts[groupId] = 0;
+  }
+  Time time = this->timeProvider();
+  // once the clock wraps, tasks from before the wrap are due whatever their time
+  bool wrapped = time < this->lastTick;
+  this->visit([&snapshot, time, wrapped](const Node& node) {
+    snapshot.count += 1;
+    if(node.getGroupId() < snapshot.groupCount) {
+      snapshot.groupCounts[node.getGroupId()] += 1;
+    }
+    bool due = node.isOverflow() == wrapped ? node.getWhen() <= time : wrapped;
+    if(due) {
+      snapshot.overdue += 1;
+      return;
+    }
+    Time left = node.leftTime(time);
+    if(snapshot.count == snapshot.overdue + 1 || left < snapshot.earliest) {
+      snapshot.earliest = left;
+    }
+    snapshot.latest = max(snapshot.latest, left);
+  });
+  return snapshot;
 }
 
-void TinyScheduler::handleOverflow() {
-  Node* node = this->head.next;
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Snapshot::toJson(Print& stream) const {
+  stream.print("{\"count\":");
+  stream.print(this->count);
+  stream.print(",\"overdue\":");
+  stream.print(this->overdue);
+  stream.print(",\"earliest\":");
+  stream.print((unsigned long) this->earliest);
+  stream.print(",\"latest\":");
+  stream.print((unsigned long) this->latest);
+  stream.print(",\"groups\":[");
+  for(GroupId groupId = 0; groupId < this->groupCount; groupId++) {
+    if(groupId != 0) {
+      stream.print(',');
+    }
+    stream.print(this->groupCounts[groupId]);
+  }
+  stream.print("]}");
+}
+
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::isEmpty() const {
+  return !this->head.hasNext() && !this->rearmed.hasNext() && !this->batch.hasNext();
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::handleOverflow() {
+  // an idle scheduler has nothing to rescan
+  if(!this->head.hasNext()) {
+    return;
+  }
+  this->hooks().onOverflowRescan();
+  Node pending;
+  pending.next = this->head.next;
+  pending.next->prev = &pending;
   this->head.next = NULL;
-  while(node != NULL) {
-    Node* next = node->next;
+  while(pending.hasNext()) {
+    Node* node = pending.next;
+    node->remove();
     if(!node->isOverflow()) {
       this->handleNode(node);
     }
     else {
-      this->addNode(node->withOverflow(false));
+      this->insertNode(node->withOverflow(false));
     }
-    node=next;
   }
+  this->mergeRearmed();
 }
 
-void TinyScheduler::handleNode(Node* node){
+/**
+ * runs an unlinked node, re-armed nodes wait in the rearmed list until mergeRearmed()
+ */
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::handleNode(Node* node){
+  this->hooks().onDispatchBegin(*node);
   bool deleteNode = node->run();
-  if (deleteNode) {
-    delete node;
+  this->finishNode(node, deleteNode);
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::finishNode(Node* node, bool done){
+  this->hooks().onDispatchEnd(*node, done);
+  // a persistent node moved back into the queue by its own callable stays where it is
+  if(node->persistent && node->isLinked()) {
+    return;
+  }
+  if (done) {
+    if(node->successor != NULL) {
+      this->resolve(node, true);
+    }
+    this->release(node);
   }
   else {
-    this->addNode(node);
+    this->defer(node);
   }
 }
 
-unsigned long TinyScheduler::tick() {
-  while (this->head.hasNext()) {
-    unsigned long delta = this->timeProvider();
-    bool overflow = this->lastTick > delta;
-    this->lastTick = delta;
-    if(overflow) {
-      this->handleOverflow();
-      continue;
+/**
+ * the executor returns once every node of the batch has run, results are handled
+ * here one by one since they change the queue
+ */
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::runBatch() {
+  if(!this->batch.hasNext()) {
+    return;
+  }
+  this->hooks().onBatchBegin();
+  for(Node* node = this->batch.next; node != NULL; node = node->next) {
+    this->hooks().onDispatchBegin(*node);
+  }
+  this->executor->execute(this->batch.next);
+  this->hooks().onBatchEnd();
+  while(this->batch.hasNext()) {
+    Node* node = this->batch.next;
+    this->batch.next = node->next;
+    node->next = NULL;
+    this->finishNode(node, node->finished);
+  }
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::release(Node* node) {
+  if(node == this->lastNode) {
+    this->lastNode = NULL;
+  }
+  if(node->successor != NULL) {
+    this->resolve(node, false);
+  }
+  node->remove();
+  if(!node->persistent) {
+    this->size -= 1;
+    node->dispose();
+  }
+}
+
+/**
+ * takes ownership of a new node, making room for it with the admission policy when
+ * evict is set. Rejected nodes are disposed
+ */
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::admit(Node* node, bool evict) {
+  node->priority = this->nextPriority;
+  this->nextPriority = 0;
+  if(node->persistent) {
+    return true;
+  }
+  node->sequence = this->admitted++;
+  if(this->capacity == 0 || this->size < this->capacity) {
+    this->size += 1;
+    return true;
+  }
+  Node* victim = NULL;
+  if(evict && this->admission == ADMIT_DROP_OLDEST) {
+    for(Node* candidate = this->head.next; candidate != NULL; candidate = candidate->next) {
+      if(candidate->isOneShot() && !candidate->persistent && (victim == NULL || (int16_t) (candidate->sequence - victim->sequence) < 0)) {
+        victim = candidate;
+      }
     }
-    Node* node = this->head.next;
-    if (node->isAfter(overflow, delta)) {
-      unsigned long leftTime = node->leftTime(delta);
-      return leftTime;
+  }
+  else if(evict && this->admission == ADMIT_DROP_LOWEST_PRIORITY) {
+    for(Node* candidate = this->head.next; candidate != NULL; candidate = candidate->next) {
+      if(!candidate->persistent && candidate->priority < node->priority && (victim == NULL || candidate->priority <= victim->priority)) {
+        victim = candidate;
+      }
     }
-    this->head.setNext(node->next);
-    this->handleNode(node);
   }
-  return 0;
+  if(victim == NULL) {
+    this->rejected += 1;
+    node->dispose();
+    return false;
+  }
+  this->dropped += 1;
+  this->hooks().onCancel(*victim);
+  this->release(victim);
+  this->size += 1;
+  return true;
+}
+
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::last() const {
+  return this->lastNode;
+}
+
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::reschedule(Node* node, Time delta) {
+  if(node == NULL || !node->isLinked()) {
+    return false;
+  }
+  Time time = this->timeProvider();
+  Time when = time + delta;
+  this->moveNode(node, when, when < time);
+  return true;
+}
+
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::postpone(Node* node, Time delta) {
+  if(node == NULL || !node->isLinked()) {
+    return false;
+  }
+  Time when = node->when + delta;
+  this->moveNode(node, when, node->overflow || when < node->when);
+  return true;
+}
+
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::setInterval(Node* node, Interval interval) {
+  if(node == NULL || !node->isLinked()) {
+    return false;
+  }
+  return node->setInterval(interval);
+}
+
+/**
+ * moves a node to its new place walking from where it is, instead of from the head,
+ * so pushing a deadline back only walks over the nodes in between
+ */
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::moveNode(Node* node, Time when, bool overflow) {
+  node->when = when;
+  node->overflow = overflow;
+  if(!node->isLinked()) {
+    this->insertNode(node);
+    return;
+  }
+  Node* prev = node->prev;
+  Node* next = node->next;
+  // sentinels are the only nodes without a previous one
+  if(prev->isLinked() && node->isBefore(*prev)) {
+    node->remove();
+    while(prev->prev->isLinked() && node->isBefore(*prev->prev)) {
+      prev = prev->prev;
+    }
+    node->linkAfter(prev->prev);
+  }
+  else if(next != NULL && next->isBefore(*node)) {
+    node->remove();
+    while(next->hasNext() && next->next->isBefore(*node)) {
+      next = next->next;
+    }
+    node->linkAfter(next);
+  }
+}
+
+/**
+ * reads the clock once for the due scan, then once more if anything ran, so the tasks
+ * that became due meanwhile run in the same tick and the wait is counted from the fresh time
+ */
+TINY_SCHEDULER_TEMPLATE
+Time TINY_SCHEDULER::tick() {
+  Time delta = this->timeProvider();
+  if(this->drain(delta)) {
+    delta = this->timeProvider();
+    if(this->drain(delta) && this->head.hasNext()) {
+      // tasks keep becoming due while others run, the caller ticks again without waiting
+      return 0;
+    }
+  }
+  if(!this->head.hasNext()) {
+    return 0;
+  }
+  return this->head.next->leftTime(delta);
+}
+
+/**
+ * due nodes are popped from the head and the re-armed ones are merged back in one pass,
+ * instead of being inserted one by one. Returns whether any node ran
+ */
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::drain(Time delta) {
+  bool ran = false;
+  bool overflow = this->lastTick > delta;
+  this->lastTick = delta;
+  if(overflow) {
+    ran = this->head.hasNext();
+    this->handleOverflow();
+  }
+  while(this->head.hasNext() && !this->head.next->isAfter(false, delta)) {
+    Node* batched = &this->batch;
+    // due nodes stay in the queue until they run, so callables can still cancel or move them
+    while(this->head.hasNext() && !this->head.next->isAfter(false, delta)) {
+      Node* node = this->head.next;
+      node->remove();
+      if(node->independent && this->executor != NULL) {
+        batched->next = node;
+        batched = node;
+      }
+      else {
+        this->handleNode(node);
+      }
+    }
+    this->runBatch();
+    this->mergeRearmed();
+    ran = true;
+  }
+  return ran;
+}
+
+/**
+ * keeps the re-armed nodes from latest to earliest, nodes run in order so
+ * re-arming with the same interval links at the front
+ */
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::defer(Node* node) {
+  Node* prev = &this->rearmed;
+  while(prev->hasNext() && prev->next->isAfter(*node)) {
+    prev = prev->next;
+  }
+  node->linkAfter(prev);
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::mergeRearmed() {
+  Node* node = &this->rearmed;
+  while(node->hasNext()) {
+    node = node->next;
+  }
+  Node* position = &this->head;
+  while(node != &this->rearmed) {
+    Node* newNode = node;
+    node = node->prev;
+    newNode->remove();
+    // a callable may have moved a re-armed node out of order
+    if(position != &this->head && newNode->isBefore(*position)) {
+      position = &this->head;
+    }
+    while(position->hasNext() && position->next->isBefore(*newNode)) {
+      position = position->next;
+    }
+    newNode->linkAfter(position);
+    position = newNode;
+  }
 }
 
-unsigned int TinyScheduler::count() const {
+TINY_SCHEDULER_TEMPLATE
+unsigned int TINY_SCHEDULER::count() const {
   if(this->isEmpty()) {
     return 0;
   }
   unsigned int counter = 0;
-  TinyScheduler::Node* node = this->head.next;
-  while(node != NULL) {
+  this->visit([&counter](const Node& node) {
     counter += 1;
-    node = node->next;
-  }
+  });
   return counter;
 }
 
 
-void TinyScheduler::loop() {
+TINY_SCHEDULER_TEMPLATE
+unsigned long TINY_SCHEDULER::toMicros(Time time) const {
+  const unsigned long limit = (unsigned long) -1;
+  unsigned long seconds = time / this->resolution;
+  unsigned long rest = (unsigned long) (time % this->resolution);
+  unsigned long fraction;
+  // rest * 1000000 overflows 32 bits, so divide first when the resolution allows it
+  if(1000000 % this->resolution == 0) {
+    fraction = rest * (1000000 / this->resolution);
+  }
+  else {
+    fraction = (unsigned long) ((unsigned long long) rest * 1000000 / this->resolution);
+  }
+  if(seconds > (limit - fraction) / 1000000) {
+    return limit;
+  }
+  return seconds * 1000000 + fraction;
+}
+
+TINY_SCHEDULER_TEMPLATE
+Interval TINY_SCHEDULER::firstInterval(Interval interval) {
+  uint16_t phase;
+  switch(this->spreading) {
+    case SPREAD_HASH:
+      // 40503 is 2^16 / golden ratio, consecutive tasks fall in the largest gap left so far
+      phase = (uint16_t) (this->spreadState++ * 40503UL);
+      break;
+    case SPREAD_RANDOM:
+      this->spreadState ^= this->spreadState << 13;
+      this->spreadState ^= this->spreadState >> 17;
+      this->spreadState ^= this->spreadState << 5;
+      phase = this->spreadState >> 16;
+      break;
+    default:
+      return interval;
+  }
+  // interval * phase / 2^16 without a wider type, the first run stays within (0, interval]
+  return interval - (interval / 65536 * phase + (Interval) (interval % 65536 * (uint32_t) phase / 65536));
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::loop() {
   while(!this->isEmpty()) {
-    const unsigned long wait = this->tick();
+    const Time wait = this->tick();
     if(wait != 0) {
+      this->hooks().onIdle(wait);
       this->delay(wait);
     }
+    else if(!this->isEmpty()) {
+      this->hooks().onIdle(wait);
+    }
   }
 }
 
-void TinyScheduler::clear() {
-  Node* node = this->head.next;
-  this->head.next = NULL;
-  while (node != NULL) {
-    Node* next = node->next;
-    delete node;
-    node = next;
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::clear() {
+  Node* lists[] = { &this->head, &this->rearmed, &this->batch };
+  for(Node* list : lists) {
+    while (list->hasNext()) {
+      this->hooks().onCancel(*list->next);
+      this->release(list->next);
+    }
   }
 }
 
 // ---- NODE -----
 
-TinyScheduler::Node::Node(): when(0) {
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::Node::Node(): when(0), groupId(0), overflow(false), persistent(false), abandoned(false), waiting(0), independent(false), finished(false), priority(0), sequence(0), successor(NULL) {
+  this->next = NULL;
+  this->prev = NULL;
+} 
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::Node::Node(Time when): when(when), groupId(0), overflow(false), persistent(false), abandoned(false), waiting(0), independent(false), finished(false), priority(0), sequence(0), successor(NULL) {
   this->next = NULL;
+  this->prev = NULL;
 } 
 
-TinyScheduler::Node::Node(unsigned long when): when(when) {
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::Node::Node(const Node& node): when(node.when), groupId(node.groupId), overflow(node.overflow), persistent(node.persistent), abandoned(false), waiting(0), independent(false), finished(false), priority(0), sequence(0), successor(NULL) {
   this->next = NULL;
+  this->prev = NULL;
 } 
 
-bool TinyScheduler::Node::isAfter(const TinyScheduler::Node& other) const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isAfter(const Node& other) const {
   if(this->overflow == other.overflow) {
     return this->when > other.when;
   }
   return this->overflow;
 } 
 
-bool TinyScheduler::Node::isBefore(const TinyScheduler::Node& other) const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isBefore(const Node& other) const {
   if(this->overflow == other.overflow) {
     return this->when < other.when;
   }
   return other.overflow;
 } 
 
-bool TinyScheduler::Node::isAfter(unsigned long delta) const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isAfter(Time delta) const {
   return this->when > delta;
 } 
 
-bool TinyScheduler::Node::isAfter(bool overflow, unsigned long delta) const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isAfter(bool overflow, Time delta) const {
   if(this->overflow == overflow) {
     return this->when > delta;
   }
   return this->overflow;
 } 
 
-bool TinyScheduler::Node::isBefore(unsigned long delta) const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isBefore(Time delta) const {
   return this->when < delta;
 } 
 
-bool TinyScheduler::Node::isBefore(bool overflow, unsigned long delta) const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isBefore(bool overflow, Time delta) const {
   if(this->overflow == overflow) {
     return this->when > delta;
   }
@@ -463,85 +2046,265 @@ bool TinyScheduler::Node::isBefore(bool overflow, unsigned long delta) const {
 } 
 
 
-unsigned long TinyScheduler::Node::leftTime(unsigned long delta) const {
+TINY_SCHEDULER_TEMPLATE
+Time TINY_SCHEDULER::Node::leftTime(Time delta) const {
   return this->when - delta;
 } 
 
-bool TinyScheduler::Node::isOverflow() const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isOverflow() const {
   return this->overflow;
 } 
 
 
 
-bool TinyScheduler::Node::hasNext() const {
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::hasNext() const {
   return this->next != NULL;
 }
 
-void TinyScheduler::Node::setNext(TinyScheduler::Node* next) {
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Node::setNext(Node* next) {
   this->next = next;
 } 
 
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isLinked() const {
+  return this->prev != NULL;
+}
+
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::Node::isWaiting() const {
+  return this->waiting != 0;
+}
+
+TINY_SCHEDULER_TEMPLATE
+Time TINY_SCHEDULER::Node::getWhen() const {
+  return this->when;
+}
+
+TINY_SCHEDULER_TEMPLATE
+GroupId TINY_SCHEDULER::Node::getGroupId() const {
+  return this->groupId;
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Node::linkAfter(Node* node) {
+  this->prev = node;
+  this->next = node->next;
+  if(this->next != NULL) {
+    this->next->prev = this;
+  }
+  node->next = this;
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Node::remove() {
+  if(!this->isLinked()) {
+    return;
+  }
+  this->prev->next = this->next;
+  if(this->next != NULL) {
+    this->next->prev = this->prev;
+  }
+  this->next = NULL;
+  this->prev = NULL;
+}
+
 
-TinyScheduler::Node* TinyScheduler::Node::withGroupId(unsigned long groupId) {
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::Node::withGroupId(GroupId groupId) {
   this->groupId = groupId;
   return this;
 } 
 
-TinyScheduler::Node* TinyScheduler::Node::withOverflow(bool overflow) {
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::Node::withOverflow(bool overflow) {
   this->overflow = overflow;
   return this;
 } 
 
-void TinyScheduler::Node::debug(Stream& stream) const {
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::Node::withIndependent(bool independent) {
+  this->independent = independent;
+  return this;
+} 
+
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::Node::getNext() const {
+  return this->next;
+} 
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Node::dispatch() {
+  this->finished = this->run();
+} 
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Node::debug(Stream& stream) const {
   stream.print("Node {");
   stream.print(" .when=");
-  stream.print(this->when);
+  stream.print((unsigned long) this->when);
   stream.print(" .groupId=");
-  stream.print(this->groupId);
+  stream.print((unsigned long) this->groupId);
   stream.print(" .overflow=");
   stream.print(this->overflow);
   stream.print(" }");
 } 
 
-TinyScheduler::Node* TinyScheduler::addNode(TinyScheduler::Node* newNode) {
-  TinyScheduler::Node* node = &this->head;
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::addNode(Node* newNode) {
+  if(!this->admit(newNode, true)) {
+    this->lastNode = NULL;
+    return NULL;
+  }
+  this->lastNode = newNode;
+  this->insertNode(newNode);
+  this->hooks().onInsert(*newNode);
+  return newNode;
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::chain(Node** predecessors, unsigned int count, Node* node) {
+  // a predecessor that cannot take the continuation rejects it
+  for(unsigned int i = 0; i < count; i++) {
+    Node* predecessor = predecessors[i];
+    if(predecessor != NULL && (predecessor->persistent || predecessor->successor != NULL)) {
+      this->nextPriority = 0;
+      this->lastNode = NULL;
+      node->dispose();
+      return;
+    }
+  }
+  // dropping a task here could free one of the predecessors
+  if(!this->admit(node, false)) {
+    this->lastNode = NULL;
+    return;
+  }
+  for(unsigned int i = 0; i < count; i++) {
+    Node* predecessor = predecessors[i];
+    // the same predecessor may be listed twice, a running one is done once its callable returns
+    if(predecessor != NULL && predecessor->successor == NULL) {
+      predecessor->successor = node;
+      node->waiting += 1;
+    }
+  }
+  this->lastNode = node;
+  if(!node->isWaiting()) {
+    Time time = this->timeProvider();
+    Time when = time + node->when;
+    this->moveNode(node, when, when < time);
+  }
+}
+
+/**
+ * queues the successor once its last predecessor is done, or drops it if one was cancelled
+ */
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::resolve(Node* predecessor, bool done) {
+  Node* node = predecessor->successor;
+  predecessor->successor = NULL;
+  node->abandoned = node->abandoned || !done;
+  node->waiting -= 1;
+  if(node->isWaiting()) {
+    return;
+  }
+  if(node->abandoned) {
+    this->hooks().onCancel(*node);
+    this->release(node);
+    return;
+  }
+  Time time = this->timeProvider();
+  Time when = time + node->when;
+  this->moveNode(node, when, when < time);
+}
+
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Node* TINY_SCHEDULER::insertNode(Node* newNode) {
+  Node* node = &this->head;
   while(node->hasNext() && node->next->isBefore(*newNode)) {
     node = node->next;
   }
-  newNode->setNext(node->next);
-  node->setNext(newNode);
+  newNode->linkAfter(node);
   return newNode;
 }
 
+// ---- RATE LIMITER -----
+
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::RateLimiter TINY_SCHEDULER::rateLimiter(unsigned int capacity, Interval interval) {
+  return RateLimiter(*this, capacity, interval);
+}
+
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::RateLimiter::RateLimiter(BasicTinyScheduler& scheduler, unsigned int capacity, Interval interval): scheduler(scheduler), tokens(capacity), capacity(capacity), interval(max((Interval) 1, interval)) {
+  this->last = scheduler.timeProvider();
+}
+
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::RateLimiter::refill() {
+  Time time = this->scheduler.timeProvider();
+  Time refilled = (Time) (time - this->last) / this->interval;
+  if(refilled >= (unsigned long) ((long) this->capacity - this->tokens)) {
+    this->tokens = this->capacity;
+    this->last = time;
+    return;
+  }
+  this->tokens += refilled;
+  this->last += refilled * this->interval;
+}
+
+TINY_SCHEDULER_TEMPLATE
+bool TINY_SCHEDULER::RateLimiter::tryAcquire() {
+  this->refill();
+  if(this->tokens <= 0) {
+    return false;
+  }
+  this->tokens -= 1;
+  return true;
+}
+
+TINY_SCHEDULER_TEMPLATE
+long TINY_SCHEDULER::RateLimiter::available() {
+  this->refill();
+  return this->tokens;
+}
+
 // ---- GROUP -----
 
-void TinyScheduler::clearGroup(unsigned long groupId) {
-  Node* prev = &this->head;
-  Node* node = this->head.next;
-  while(node != NULL) {
-    bool removeIt = node->groupId == groupId;
-    if(removeIt) {
-      prev->next = node->next;
-      delete node;
-    }
-    else{
-      prev = node;
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::clearGroup(GroupId groupId) {
+  Node* lists[] = { &this->head, &this->rearmed, &this->batch };
+  for(Node* list : lists) {
+    Node* node = list->next;
+    while(node != NULL) {
+      Node* next = node->next;
+      if(node->groupId == groupId) {
+        this->hooks().onCancel(*node);
+        this->release(node);
+      }
+      node = next;
     }
-    node = prev->next;
   }
 }
 
-TinyScheduler::Group TinyScheduler::group() {
+TINY_SCHEDULER_TEMPLATE
+typename TINY_SCHEDULER::Group TINY_SCHEDULER::group() {
   return Group(*this, this->getNextGroupId());
 }
 
 
-TinyScheduler::Group::Group(TinyScheduler& scheduler, unsigned long id): scheduler(scheduler), id(id) {
+TINY_SCHEDULER_TEMPLATE
+TINY_SCHEDULER::Group::Group(BasicTinyScheduler& scheduler, GroupId id): scheduler(scheduler), id(id) {
 
 }
 
-void TinyScheduler::Group::clear() {
+TINY_SCHEDULER_TEMPLATE
+void TINY_SCHEDULER::Group::clear() {
   this->scheduler.clearGroup(this->id);
 }
 
+#undef TINY_SCHEDULER_TEMPLATE
+#undef TINY_SCHEDULER
+
 #endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+/**
+ * TinyStaticScheduler.h
+ *
+ * A scheduler for task lists known at compile time:
+ *
+ *   TinyStaticScheduler<Every<1000, toggleLed>, Every<50, readSensor>> scheduler(::millis, ::delay);
+ *
+ * The dispatch is unrolled at compile time into direct calls, the only RAM used
+ * is one deadline per task and nothing is allocated.
+ *
+ * Deadlines are compared with a wrap safe difference, so intervals must be
+ * shorter than half the range of the time provider.
+ */
+
+#ifndef __TINY_STATIC_SCHEDULER__
+#define __TINY_STATIC_SCHEDULER__
+
+#include "TinyScheduler.h"
+
+template<unsigned long Interval, void (*Callback)(), unsigned long FirstInterval = Interval>
+struct Every {
+  static const unsigned long interval = Interval;
+  static const unsigned long firstInterval = FirstInterval;
+
+  static void run() {
+    Callback();
+  }
+};
+
+template<unsigned int Index, typename... Tasks>
+struct TinyStaticDispatch {
+  static void start(unsigned long* when, unsigned long time) {
+  }
+
+  static void tick(unsigned long* when, unsigned long time, unsigned long& leftTime) {
+  }
+};
+
+template<unsigned int Index, typename Task, typename... Tasks>
+struct TinyStaticDispatch<Index, Task, Tasks...> {
+  static void start(unsigned long* when, unsigned long time) {
+    when[Index] = time + Task::firstInterval;
+    TinyStaticDispatch<Index + 1, Tasks...>::start(when, time);
+  }
+
+  static void tick(unsigned long* when, unsigned long time, unsigned long& leftTime) {
+    if((long) (when[Index] - time) <= 0) {
+      Task::run();
+      when[Index] += Task::interval;
+    }
+    long left = when[Index] - time;
+    if(left <= 0) {
+      leftTime = 0;
+    }
+    else if((unsigned long) left < leftTime) {
+      leftTime = left;
+    }
+    TinyStaticDispatch<Index + 1, Tasks...>::tick(when, time, leftTime);
+  }
+};
+
+template<typename... Tasks>
+class TinyStaticScheduler {
+public:
+
+  static_assert(sizeof...(Tasks) > 0, "TinyStaticScheduler needs at least one task");
+
+  TinyStaticScheduler(TimeProvider timeProvider, Delay delay) : timeProvider(timeProvider), delay(delay) {
+    this->start();
+  }
+  static TinyStaticScheduler millis() {
+    return TinyStaticScheduler(::millis, ::delay);
+  }
+  static TinyStaticScheduler micros() {
+    return TinyStaticScheduler(::micros, usDelay);
+  }
+
+  /**
+   * counts the first intervals from now
+   */
+  void start() {
+    TinyStaticDispatch<0, Tasks...>::start(this->when, this->timeProvider());
+  }
+
+  /**
+   * runs the due tasks in declaration order, returns the time left until the next one
+   */
+  unsigned long tick() {
+    unsigned long leftTime = (unsigned long) -1;
+    TinyStaticDispatch<0, Tasks...>::tick(this->when, this->timeProvider(), leftTime);
+    return leftTime;
+  }
+
+  /**
+   * periodic tasks never end, so it never returns
+   */
+  void loop() {
+    while(true) {
+      const unsigned long wait = this->tick();
+      if(wait != 0) {
+        this->delay(wait);
+      }
+    }
+  }
+
+  static constexpr unsigned int count() {
+    return sizeof...(Tasks);
+  }
+
+private:
+  TimeProvider timeProvider;
+  Delay delay;
+  unsigned long when[sizeof...(Tasks)];
+};
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * TinyThreadPool.h
+ *
+ * Executor running the independent tasks due at the same tick on a pool of threads:
+ *
+ *   TinyThreadPool<TinyScheduler> pool(4);
+ *   scheduler.withExecutor(&pool);
+ *   scheduler.every(5, readSensor).independent();
+ *
+ * tick() waits for the whole batch, so the tasks of the next deadline never overlap it.
+ * The scheduler is not locked, the tasks must not add, cancel or re-arm tasks.
+ * Needs std::thread, so it is meant for Linux, ESP32 and similar targets.
+ */
+
+#ifndef __TINY_THREAD_POOL__
+#define __TINY_THREAD_POOL__
+
+#include "TinyScheduler.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template<typename Scheduler>
+class TinyThreadPool : public Scheduler::Executor {
+public:
+
+  typedef typename Scheduler::Node Node;
+
+  /**
+   * the thread calling tick() runs tasks too, so threads - 1 workers are started
+   */
+  TinyThreadPool(unsigned int threads) {
+    for(unsigned int i = 1; i < threads; i++) {
+      this->workers.emplace_back(&TinyThreadPool::work, this);
+    }
+  }
+
+  ~TinyThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stopping = true;
+    }
+    this->ready.notify_all();
+    for(std::thread& worker : this->workers) {
+      worker.join();
+    }
+  }
+
+  void execute(Node* first) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->cursor = first;
+    this->running = 0;
+    this->generation += 1;
+    this->ready.notify_all();
+    this->drain(lock);
+    this->done.wait(lock, [this]() {
+      return this->cursor == NULL && this->running == 0;
+    });
+  }
+
+  unsigned int size() const {
+    return this->workers.size() + 1;
+  }
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable done;
+  Node* cursor = NULL;
+  unsigned int running = 0;
+  unsigned long generation = 0;
+  bool stopping = false;
+
+  /**
+   * takes nodes from the batch until it is empty, the lock is released while a node runs
+   */
+  void drain(std::unique_lock<std::mutex>& lock) {
+    while(this->cursor != NULL) {
+      Node* node = this->cursor;
+      this->cursor = node->getNext();
+      this->running += 1;
+      lock.unlock();
+      node->dispatch();
+      lock.lock();
+      this->running -= 1;
+    }
+    if(this->running == 0) {
+      this->done.notify_all();
+    }
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    unsigned long seen = 0;
+    while(true) {
+      this->ready.wait(lock, [this, seen]() {
+        return this->stopping || (this->generation != seen && this->cursor != NULL);
+      });
+      if(this->stopping) {
+        return;
+      }
+      seen = this->generation;
+      this->drain(lock);
+    }
+  }
+};
+
+#endif
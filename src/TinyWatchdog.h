@@ -0,0 +1,142 @@
+/**
+ * TinyWatchdog.h
+ *
+ * Hooks policy reporting the tasks that run longer than a threshold:
+ *
+ *   BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyWatchdog> scheduler(millis, delay);
+ *   scheduler.hooks().begin(millis, 50, reportOverrun);
+ *
+ * The run time is checked against the time provider once each task returns, tasks
+ * whose deadline passed while it was running are counted as slipped.
+ * Tasks run in parallel by an executor are measured as one batch, an overrun of the
+ * batch is counted and reported once.
+ */
+
+#ifndef __TINY_WATCHDOG__
+#define __TINY_WATCHDOG__
+
+#include "TinyScheduler.h"
+
+struct TinyOverrun {
+  /**
+   * the node of the task, it may be released right after the report. NULL for a batch
+   */
+  const void* task;
+  unsigned long groupId;
+  unsigned long elapsed;
+};
+
+class TinyWatchdog : public TinyNoHooks {
+public:
+
+  typedef void (*Report)(const TinyOverrun& overrun);
+
+  /**
+   * threshold is in time provider units, report is optional
+   */
+  void begin(TimeProvider timeProvider, unsigned long threshold, Report report = NULL) {
+    this->timeProvider = timeProvider;
+    this->threshold = threshold;
+    this->report = report;
+  }
+
+  void onBatchBegin() {
+    if(this->timeProvider == NULL) {
+      return;
+    }
+    this->started = this->timeProvider();
+    this->batching = true;
+  }
+
+  void onBatchEnd() {
+    if(this->timeProvider == NULL) {
+      return;
+    }
+    this->batching = false;
+    this->check(NULL, 0);
+  }
+
+  template<typename Node>
+  void onDispatchBegin(const Node& node) {
+    if(this->timeProvider == NULL) {
+      return;
+    }
+    if(this->batching) {
+      this->batched += 1;
+    }
+    else {
+      this->started = this->timeProvider();
+    }
+    // a deadline inside the last overrun was delayed by it
+    typedef decltype(node.getWhen()) Time;
+    if(this->slipping && (Time) (node.getWhen() - (Time) this->overrunStart) < (Time) (this->overrunEnd - this->overrunStart)) {
+      this->slipped += 1;
+    }
+  }
+
+  template<typename Node>
+  void onDispatchEnd(const Node& node, bool done) {
+    if(this->timeProvider == NULL) {
+      return;
+    }
+    // measured by onBatchEnd()
+    if(this->batched > 0) {
+      this->batched -= 1;
+      return;
+    }
+    this->check(&node, (unsigned long) node.getGroupId());
+  }
+
+  /**
+   * the scheduler caught up with its deadlines, tick() reads the clock again after an
+   * overrun and runs the tasks it delayed before returning a wait
+   */
+  template<typename Time>
+  void onIdle(Time wait) {
+    if(wait != 0) {
+      this->slipping = false;
+    }
+  }
+
+  unsigned long getOverruns() const {
+    return this->overruns;
+  }
+
+  unsigned long getSlipped() const {
+    return this->slipped;
+  }
+
+protected:
+  TimeProvider timeProvider = NULL;
+  unsigned long threshold = 0;
+  Report report = NULL;
+  unsigned long started = 0;
+
+private:
+  bool batching = false;
+  // batch tasks whose end is still to come
+  unsigned int batched = 0;
+  unsigned long overrunStart = 0;
+  unsigned long overrunEnd = 0;
+  bool slipping = false;
+  unsigned long overruns = 0;
+  unsigned long slipped = 0;
+
+  void check(const void* task, unsigned long groupId) {
+    unsigned long ended = this->timeProvider();
+    unsigned long elapsed = ended - this->started;
+    if(elapsed <= this->threshold) {
+      return;
+    }
+    this->overruns += 1;
+    this->slipping = true;
+    this->overrunStart = this->started;
+    this->overrunEnd = ended;
+    if(this->report != NULL) {
+      TinyOverrun overrun = { task, groupId, elapsed };
+      this->report(overrun);
+    }
+  }
+};
+
+#endif
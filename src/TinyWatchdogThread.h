@@ -0,0 +1,133 @@
+/**
+ * TinyWatchdogThread.h
+ *
+ * TinyWatchdog with a monitor thread, so a task that blocks is reported while it is
+ * still running instead of once it returns:
+ *
+ *   BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyWatchdogThread> scheduler(millis, delay);
+ *   scheduler.hooks().begin(millis, 50, reportOverrun, reportStall);
+ *
+ * The stall report is called from the monitor thread, once per blocking task.
+ * Needs std::thread, so it is meant for Linux, ESP32 and similar targets.
+ */
+
+#ifndef __TINY_WATCHDOG_THREAD__
+#define __TINY_WATCHDOG_THREAD__
+
+#include "TinyWatchdog.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class TinyWatchdogThread : public TinyWatchdog {
+public:
+
+  ~TinyWatchdogThread() {
+    this->stop();
+  }
+
+  /**
+   * stall is called from the monitor thread, which checks the running task every millisecond
+   */
+  void begin(TimeProvider timeProvider, unsigned long threshold, Report report = NULL, Report stall = NULL) {
+    this->stop();
+    TinyWatchdog::begin(timeProvider, threshold, report);
+    this->stall = stall;
+    this->stopping = false;
+    this->monitor = std::thread(&TinyWatchdogThread::watch, this);
+  }
+
+  void stop() {
+    if(!this->monitor.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stopping = true;
+    }
+    this->wake.notify_all();
+    this->monitor.join();
+  }
+
+  void onBatchBegin() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    TinyWatchdog::onBatchBegin();
+    this->start(NULL, 0);
+  }
+
+  void onBatchEnd() {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->running = false;
+    }
+    TinyWatchdog::onBatchEnd();
+  }
+
+  template<typename Node>
+  void onDispatchBegin(const Node& node) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    const bool batched = this->running;
+    TinyWatchdog::onDispatchBegin(node);
+    if(!batched) {
+      this->start(&node, node.getGroupId());
+    }
+  }
+
+  template<typename Node>
+  void onDispatchEnd(const Node& node, bool done) {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->running = false;
+    }
+    TinyWatchdog::onDispatchEnd(node, done);
+  }
+
+  unsigned long getStalls() const {
+    return this->stalls;
+  }
+
+private:
+  Report stall = NULL;
+  std::thread monitor;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  bool running = false;
+  // NULL for a batch
+  const void* task = NULL;
+  unsigned long groupId = 0;
+  bool reported = false;
+
+  void start(const void* task, unsigned long groupId) {
+    this->running = true;
+    this->task = task;
+    this->groupId = groupId;
+    this->reported = false;
+  }
+  std::atomic<unsigned long> stalls{0};
+
+  void watch() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while(!this->stopping) {
+      this->wake.wait_for(lock, std::chrono::milliseconds(1));
+      if(!this->running || this->reported) {
+        continue;
+      }
+      unsigned long elapsed = this->timeProvider() - this->started;
+      if(elapsed <= this->threshold) {
+        continue;
+      }
+      this->reported = true;
+      this->stalls += 1;
+      if(this->stall != NULL) {
+        TinyOverrun overrun = { this->task, this->groupId, elapsed };
+        this->stall(overrun);
+      }
+    }
+  }
+};
+
+#endif
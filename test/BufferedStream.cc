@@ -0,0 +1,81 @@
+#include "TinyScheduler.h"
+
+#include "Arduino.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+std::string drain(int fd) {
+  std::string result;
+  char buffer[1024];
+  ssize_t length;
+  while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+    result.append(buffer, length);
+  }
+  return result;
+}
+
+TEST(BufferedStream, Flush) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  {
+    BufferedStream stream(fds[1]);
+    stream.print("100% ");
+    stream.print(42);
+    stream.write((const uint8_t*) " done", 5);
+    stream.flush();
+  }
+  close(fds[1]);
+  ASSERT_EQ(drain(fds[0]), "100% 42 done");
+  close(fds[0]);
+}
+
+TEST(BufferedStream, Large) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  std::string expected;
+  {
+    BufferedStream stream(fds[1]);
+    stream.startWriter();
+    for (int i = 0; i < 1000; i++) {
+      stream.println(i);
+      expected += std::to_string(i) + "\r\n";
+    }
+    std::string block(3 * BufferedStream::CAPACITY + 7, 'x');
+    stream.write(block.c_str(), block.size());
+    expected += block;
+    // a full pipe would block the writer, so the reader runs before the stream is destroyed
+    std::string result;
+    pthread_t reader;
+    pthread_create(&reader, NULL, [](void* fd) -> void* {
+      return new std::string(drain(*(int*) fd));
+    }, &fds[0]);
+    stream.stopWriter();
+    close(fds[1]);
+    void* drained;
+    pthread_join(reader, &drained);
+    result = *(std::string*) drained;
+    delete (std::string*) drained;
+    ASSERT_EQ(result, expected);
+  }
+  close(fds[0]);
+}
+
+TEST(BufferedStream, Debug) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  {
+    BufferedStream stream(fds[1]);
+    TinyScheduler scheduler(millis, delay);
+    scheduler.timeout(1000, [](){});
+    scheduler.debug(stream);
+  }
+  close(fds[1]);
+  ASSERT_NE(drain(fds[0]).find("TinyScheduler Tasks:"), std::string::npos);
+  close(fds[0]);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+#include "Clock.h"
+#include "TinyScheduler.h"
+
+#include "Arduino.h"
+#include <gtest/gtest.h>
+
+TEST(Clock, Monotonic) {
+  unsigned long coarse = coarseNanos();
+  unsigned long tsc = tscNanos();
+  for (int i = 0; i < 1000; i++) {
+    unsigned long nextCoarse = coarseNanos();
+    unsigned long nextTsc = tscNanos();
+    ASSERT_GE(nextCoarse, coarse);
+    ASSERT_GE(nextTsc, tsc);
+    coarse = nextCoarse;
+    tsc = nextTsc;
+  }
+}
+
+TEST(Clock, Delay) {
+  unsigned long start = tscNanos();
+  unsigned long coarseStart = coarseNanos();
+  nsDelay(20000000);
+  unsigned long elapsed = tscNanos() - start;
+  ASSERT_GE(elapsed, 19000000UL);
+  ASSERT_LT(elapsed, 200000000UL);
+  ASSERT_GE(coarseNanos() - coarseStart, 10000000UL);
+}
+
+TEST(Clock, Scheduler) {
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(tscNanos, nsDelay, 1000000000);
+  scheduler.repeat(3, 1000000, [counterAddress](){
+    *counterAddress += 1;
+  });
+  scheduler.loop();
+  ASSERT_EQ(counter, 3);
+}
+
+TEST(Clock, PreciseDelay) {
+  resetDelayStats();
+  for (int i = 0; i < 20; i++) {
+    unsigned long start = tscNanos();
+    preciseDelay(500000);
+    unsigned long elapsed = tscNanos() - start;
+    ASSERT_GE(elapsed, 499000UL);
+    ASSERT_LT(elapsed, 50000000UL);
+  }
+  DelayStats stats = getDelayStats();
+  ASSERT_EQ(stats.count, 20);
+  ASSERT_LE(stats.percentile(0.99), stats.max);
+  ASSERT_LE(stats.mean(), stats.max);
+}
+
+TEST(Clock, SpinThreshold) {
+  const unsigned long threshold = getSpinThreshold();
+  unsigned long calibrated = calibrateSpinThreshold(20);
+  ASSERT_EQ(getSpinThreshold(), calibrated);
+  setSpinThreshold(0);
+  unsigned long start = tscNanos();
+  delayMicroseconds(300);
+  ASSERT_GE(tscNanos() - start, 299000UL);
+  setSpinThreshold(threshold);
+}
+
+TEST(Clock, DelayStats) {
+  DelayStats stats;
+  ASSERT_EQ(stats.percentile(0.99), 0);
+  stats.add(0);
+  stats.add(1);
+  stats.add(1000);
+  stats.add(1000000);
+  ASSERT_EQ(stats.count, 4);
+  ASSERT_EQ(stats.mean(), 250250);
+  ASSERT_EQ(stats.percentile(0.25), 1);
+  ASSERT_EQ(stats.percentile(0.5), 1023);
+  ASSERT_EQ(stats.percentile(1.0), 1000000);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+#include "TinyArrayScheduler.h"
+
+#include "Arduino.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+unsigned long timer = 0;
+
+unsigned long getTimer() {
+  return timer;
+}
+
+void noDelay(unsigned long ignore) {
+
+}
+
+int counter = 0;
+
+void increment() {
+  counter += 1;
+}
+
+void noop() {
+
+}
+
+TEST(ArrayScheduler, Timeout) {
+  timer = 0;
+  counter = 0;
+  TinyArrayScheduler<4> scheduler(getTimer, noDelay);
+  scheduler.timeout(5, increment);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 4;
+  ASSERT_EQ(scheduler.tick(), 1);
+  ASSERT_EQ(counter, 0);
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 0);
+  ASSERT_EQ(counter, 1);
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(ArrayScheduler, Every) {
+  timer = 0;
+  counter = 0;
+  TinyArrayScheduler<4> scheduler(getTimer, noDelay);
+  scheduler.every(2, increment);
+  for(timer=0;timer<10;timer++) {
+    scheduler.tick();
+    ASSERT_EQ(counter, timer / 2);
+  }
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+void slow() {
+  timer += 50;
+}
+
+TEST(ArrayScheduler, SlowTask) {
+  timer = 0;
+  counter = 0;
+  TinyArrayScheduler<4> scheduler(getTimer, noDelay);
+  scheduler.timeout(0, slow);
+  scheduler.timeout(30, increment);
+  scheduler.timeout(80, noop);
+  // the task due during the slow one ran late, so there is no wait to trust
+  ASSERT_EQ(scheduler.tick(), 0);
+  ASSERT_EQ(counter, 1);
+  ASSERT_EQ(scheduler.count(), 1);
+  ASSERT_EQ(scheduler.tick(), 30);
+}
+
+TEST(ArrayScheduler, Capacity) {
+  timer = 0;
+  TinyArrayScheduler<2> scheduler(getTimer, noDelay);
+  ASSERT_EQ(scheduler.timeout(1, noop), 0);
+  ASSERT_EQ(scheduler.timeout(1, noop), 1);
+  ASSERT_EQ(scheduler.timeout(1, noop), -1);
+  timer = 1;
+  scheduler.tick();
+  ASSERT_TRUE(scheduler.isEmpty());
+  ASSERT_NE(scheduler.timeout(1, noop), -1);
+}
+
+TEST(ArrayScheduler, CancelAndReschedule) {
+  timer = 0;
+  counter = 0;
+  TinyArrayScheduler<8> scheduler(getTimer, noDelay);
+  int first = scheduler.timeout(5, increment);
+  int second = scheduler.timeout(5, increment);
+  scheduler.timeout(20, noop);
+  ASSERT_TRUE(scheduler.cancel(first));
+  ASSERT_FALSE(scheduler.cancel(first));
+  ASSERT_FALSE(scheduler.isPending(first));
+  ASSERT_TRUE(scheduler.reschedule(second, 10));
+  timer = 9;
+  ASSERT_EQ(scheduler.tick(), 1);
+  ASSERT_EQ(counter, 0);
+  timer = 10;
+  ASSERT_EQ(scheduler.tick(), 10);
+  ASSERT_EQ(counter, 1);
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+TEST(ArrayScheduler, Overflow) {
+  timer = -5;
+  counter = 0;
+  TinyArrayScheduler<4> scheduler(getTimer, noDelay);
+  scheduler.every(10, increment);
+  timer = 4;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(ArrayScheduler, ManyTimers) {
+  timer = 0;
+  counter = 0;
+  TinyArrayScheduler<1000> scheduler(getTimer, noDelay);
+  srand(42);
+  int fired[101] = {0};
+  for(int i = 0; i < 1000; i++) {
+    int delta = rand() % 101;
+    fired[delta] += 1;
+    scheduler.timeout(delta, increment);
+  }
+  int expected = 0;
+  for(timer = 0; timer <= 100; timer++) {
+    expected += fired[timer];
+    scheduler.tick();
+    ASSERT_EQ(counter, expected);
+    ASSERT_EQ(scheduler.count(), 1000 - expected);
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
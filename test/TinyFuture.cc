@@ -0,0 +1,81 @@
+#include "TinyFuture.h"
+
+#include "Arduino.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+std::atomic<unsigned long> timer(0);
+
+unsigned long getTimer() {
+  return timer;
+}
+
+void noDelay(unsigned long ignore) {
+
+}
+
+TEST(Future, Get) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyFuture<int> future = scheduler.timeoutAsync(5, []() {
+    return 42;
+  });
+  ASSERT_FALSE(future.isReady());
+  ASSERT_FALSE(future.waitFor(1));
+  int value = 0;
+  std::thread waiter([&value, future]() {
+    value = future.get();
+  });
+  timer = 5;
+  scheduler.tick();
+  waiter.join();
+  ASSERT_EQ(value, 42);
+  ASSERT_TRUE(future.isReady());
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(Future, Void) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyFuture<void> future = scheduler.timeoutAsync(0, [counterAddress]() {
+    *counterAddress += 1;
+  });
+  scheduler.tick();
+  ASSERT_TRUE(future.wait());
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(Future, Cancelled) {
+  timer = 0;
+  TinyFuture<std::string> future;
+  {
+    TinyScheduler scheduler(getTimer, noDelay);
+    future = scheduler.timeoutAsync(5, []() {
+      return std::string("never");
+    });
+  }
+  ASSERT_TRUE(future.isCancelled());
+  ASSERT_FALSE(future.wait());
+  ASSERT_EQ(future.get(), "");
+}
+
+TEST(Future, Dropped) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeoutAsync(5, []() {
+    return 1;
+  });
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+#include "TinyHybridScheduler.h"
+
+#include "Arduino.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+unsigned long timer = 0;
+
+unsigned long getMicros() {
+  return timer;
+}
+
+unsigned long getMillis() {
+  return timer / 1000;
+}
+
+TEST(HybridScheduler, Routing) {
+  timer = 0;
+  int counter = 0;
+  TinyHybridScheduler scheduler(10000, getMillis, getMicros);
+  scheduler.timeout(250, [&counter]() { counter += 1; });
+  ASSERT_EQ(scheduler.fine().count(), 1);
+  scheduler.timeout(3600000000ULL, [&counter]() { counter += 10; });
+  ASSERT_EQ(scheduler.coarse().count(), 1);
+  ASSERT_TRUE(scheduler.last() != NULL);
+  ASSERT_EQ(scheduler.count(), 2);
+  ASSERT_EQ(scheduler.tick(), 250);
+  timer = 249;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  timer = 250;
+  ASSERT_EQ(scheduler.tick(), 3600000000UL);
+  ASSERT_EQ(counter, 1);
+  ASSERT_TRUE(scheduler.last() != NULL);
+  scheduler.timeout(10, []() {});
+  timer = 260;
+  scheduler.tick();
+  // the fine task is done, last() does not keep it
+  ASSERT_TRUE(scheduler.last() == NULL);
+  scheduler.clear();
+  ASSERT_TRUE(scheduler.isEmpty());
+  ASSERT_EQ(scheduler.tick(), 0);
+}
+
+TEST(HybridScheduler, Rounding) {
+  timer = 0;
+  int counter = 0;
+  TinyHybridScheduler scheduler(1000, getMillis, getMicros);
+  scheduler.timeout(1000, [&counter]() { counter += 1; });
+  scheduler.timeout(1001, [&counter]() { counter += 10; });
+  ASSERT_EQ(scheduler.coarse().count(), 2);
+  timer = 1000;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  timer = 1999;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  timer = 2000;
+  scheduler.tick();
+  ASSERT_EQ(counter, 11);
+}
+
+TEST(HybridScheduler, Every) {
+  timer = 0;
+  int fast = 0;
+  int slow = 0;
+  TinyHybridScheduler scheduler(10000, getMillis, getMicros);
+  scheduler.every(500, [&fast]() { fast += 1; });
+  scheduler.repeat(3, 20000, [&slow]() { slow += 1; });
+  for(timer = 0; timer <= 100000; timer += 100) {
+    scheduler.tick();
+  }
+  ASSERT_EQ(fast, 200);
+  ASSERT_EQ(slow, 3);
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,70 @@
+#include "TinyLoopMetrics.h"
+
+#include "Arduino.h"
+#include <gtest/gtest.h>
+
+unsigned long timer = 0;
+
+unsigned long getTimer() {
+  return timer;
+}
+
+void advance(unsigned long wait) {
+  timer += wait;
+}
+
+typedef BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyLoopMetrics> MeasuredScheduler;
+
+TEST(LoopMetrics, Split) {
+  timer = 0;
+  MeasuredScheduler scheduler(getTimer, advance);
+  scheduler.hooks().begin(getTimer, 80);
+  scheduler.repeat(5, 10, []() {
+    timer += 3;
+  });
+  scheduler.loop();
+  ASSERT_EQ(timer, 53);
+  ASSERT_EQ(scheduler.hooks().getUtilization(), 15 * 100 / 53);
+  ASSERT_EQ(scheduler.hooks().getBusy(), 15);
+  ASSERT_EQ(scheduler.hooks().getIdle(), 38);
+  ASSERT_EQ(scheduler.hooks().getSaturated(), 0);
+}
+
+TEST(LoopMetrics, Saturated) {
+  timer = 0;
+  MeasuredScheduler scheduler(getTimer, advance);
+  scheduler.hooks().begin(getTimer, 80);
+  scheduler.repeat(4, 5, []() {
+    timer += 8;
+  });
+  scheduler.loop();
+  ASSERT_EQ(timer, 37);
+  // the tick at 5 runs the run due at 10 late too and has no wait left, the last tick empties the queue
+  ASSERT_EQ(scheduler.hooks().getSaturated(), 1);
+  ASSERT_EQ(scheduler.hooks().getUtilization(), 32 * 100 / 37);
+  ASSERT_EQ(scheduler.hooks().getBusy(), 32);
+}
+
+TEST(LoopMetrics, Window) {
+  timer = 0;
+  TinyLoopMetrics metrics;
+  ASSERT_EQ(metrics.getUtilization(), 0);
+  metrics.begin(getTimer, 80);
+  timer = 100;
+  metrics.onIdle(1UL);
+  ASSERT_EQ(metrics.getBusy(), 100);
+  timer = 200;
+  ASSERT_EQ(metrics.getUtilization(), 0);
+  metrics.onDispatchBegin(0);
+  timer = 240;
+  ASSERT_EQ(metrics.getUtilization(), 40 * 100 / 70);
+  timer = 1000;
+  ASSERT_EQ(metrics.getUtilization(), 100);
+  ASSERT_EQ(metrics.getIdle(), 100);
+  ASSERT_EQ(metrics.getBusy(), 900);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -4,10 +4,11 @@
 #include <cmath>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 
-using namespace scheduler;
+
 
 unsigned long timer = 0;
 
@@ -25,34 +26,34 @@ void noop() {
 
 TEST(Scheduler, Init) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
 }
 
 TEST(Scheduler, AddNode) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
-  scheduler.addNode(new Scheduler::Node());
+  TinyScheduler scheduler(getTimer, delay);
+  scheduler.addNode(new TinyScheduler::Node());
   ASSERT_EQ(scheduler.count(), 1);
 }
 
 TEST(Scheduler, AddMultipleNode) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
-  scheduler.addNode(new Scheduler::Node());
-  scheduler.addNode(new Scheduler::Node());
-  scheduler.addNode(new Scheduler::Node());
-  scheduler.addNode(new Scheduler::Node());
+  TinyScheduler scheduler(getTimer, delay);
+  scheduler.addNode(new TinyScheduler::Node());
+  scheduler.addNode(new TinyScheduler::Node());
+  scheduler.addNode(new TinyScheduler::Node());
+  scheduler.addNode(new TinyScheduler::Node());
   ASSERT_EQ(scheduler.count(), 4);
 }
 
 
 TEST(Scheduler, RemoveWithTick) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
-  scheduler.addNode(new Scheduler::Node(1));
-  scheduler.addNode(new Scheduler::Node(2));
-  scheduler.addNode(new Scheduler::Node(3));
-  scheduler.addNode(new Scheduler::Node(4));
+  TinyScheduler scheduler(getTimer, delay);
+  scheduler.addNode(new TinyScheduler::Node(1));
+  scheduler.addNode(new TinyScheduler::Node(2));
+  scheduler.addNode(new TinyScheduler::Node(3));
+  scheduler.addNode(new TinyScheduler::Node(4));
   timer = 0;
   scheduler.tick();
   ASSERT_EQ(scheduler.count(), 4);
@@ -72,11 +73,11 @@ TEST(Scheduler, RemoveWithTick) {
 
 TEST(Scheduler, RemoveAllWithTick) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
-  scheduler.addNode(new Scheduler::Node(1));
-  scheduler.addNode(new Scheduler::Node(2));
-  scheduler.addNode(new Scheduler::Node(3));
-  scheduler.addNode(new Scheduler::Node(4));
+  TinyScheduler scheduler(getTimer, delay);
+  scheduler.addNode(new TinyScheduler::Node(1));
+  scheduler.addNode(new TinyScheduler::Node(2));
+  scheduler.addNode(new TinyScheduler::Node(3));
+  scheduler.addNode(new TinyScheduler::Node(4));
   timer = 0;
   ASSERT_EQ(scheduler.count(), 4);
   timer = 4;
@@ -87,11 +88,11 @@ TEST(Scheduler, RemoveAllWithTick) {
 
 TEST(Scheduler, RemoveAllWithLoop) {
   timer = 0;
-  Scheduler scheduler = Scheduler::micros();
-  scheduler.addNode(new Scheduler::Node(1));
-  scheduler.addNode(new Scheduler::Node(2));
-  scheduler.addNode(new Scheduler::Node(3));
-  scheduler.addNode(new Scheduler::Node(4));
+  TinyScheduler scheduler = TinyScheduler::micros();
+  scheduler.addNode(new TinyScheduler::Node(1));
+  scheduler.addNode(new TinyScheduler::Node(2));
+  scheduler.addNode(new TinyScheduler::Node(3));
+  scheduler.addNode(new TinyScheduler::Node(4));
   ASSERT_EQ(scheduler.count(), 4);
   scheduler.loop();
   ASSERT_EQ(scheduler.count(), 0);
@@ -102,7 +103,7 @@ TEST(Scheduler, Timeout) {
   timer = 0;
   bool done = false;
   bool* doneAddress = &done;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.timeout(5, [doneAddress](){
     *doneAddress = true;
   });
@@ -122,7 +123,7 @@ TEST(Scheduler, Every) {
   timer = 0;
   int counter = 0;
   int* counterAddress = &counter;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.every(2, [counterAddress](){
     *counterAddress += 1;
   });
@@ -140,7 +141,7 @@ TEST(Scheduler, EveryWithFirstInterval) {
   int counter = -1;
   int* counterAddress = &counter;
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.every(0, 1, [counterAddress](){
     *counterAddress += 1;
   });
@@ -157,7 +158,7 @@ TEST(Scheduler, RepeatAndLoop) {
   timer = 0;
   int counter = 0;
   int* counterAddress = &counter;
-  Scheduler scheduler = Scheduler::micros();
+  TinyScheduler scheduler = TinyScheduler::micros();
   scheduler.repeat(10, 1, [counterAddress](){
     *counterAddress += 1;
   });
@@ -173,7 +174,7 @@ TEST(Scheduler, RepeatWithFirstInterval) {
   int counter = 0;
   int* counterAddress = &counter;
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.repeat(10, 0, 1, [counterAddress](){
     *counterAddress += 1;
   });
@@ -188,11 +189,11 @@ TEST(Scheduler, RepeatWithFirstInterval) {
 
 
 TEST(Scheduler_Node, Init) {
-  Scheduler::Node node;
+  TinyScheduler::Node node;
 }
 
 TEST(Scheduler, ClearOne) {
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.timeout(1000, noop);
   ASSERT_EQ(scheduler.count(), 1);
   scheduler.clear();
@@ -200,7 +201,7 @@ TEST(Scheduler, ClearOne) {
 }
 
 TEST(Scheduler, ClearMany) {
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.timeout(1000, noop);
   scheduler.repeat(10, 1000, noop);
   scheduler.every(1000, noop);
@@ -211,9 +212,9 @@ TEST(Scheduler, ClearMany) {
 
 TEST(Scheduler_Group, Timeout) {
   timer = 0;
-  bool done;
+  bool done = false;
   bool* doneAddress = &done;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.group().timeout(5, [doneAddress](){
     *doneAddress = true;
   });
@@ -231,7 +232,7 @@ TEST(Scheduler_Group, Every) {
   timer = 0;
   int counter = 0;
   int* counterAddress = &counter;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.group().every(2, [counterAddress](){
     *counterAddress += 1;
   });
@@ -248,7 +249,7 @@ TEST(Scheduler_Group, EveryWithFirstInterval) {
   int counter = -1;
   int* counterAddress = &counter;
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.group().every(0, 1, [counterAddress](){
     *counterAddress += 1;
   });
@@ -265,7 +266,7 @@ TEST(Scheduler_Group, RepeatAndLoop) {
   timer = 0;
   int counter = 0;
   int* counterAddress = &counter;
-  Scheduler scheduler = Scheduler::micros();
+  TinyScheduler scheduler = TinyScheduler::micros();
   scheduler.group().repeat(10, 1, [counterAddress](){
     *counterAddress += 1;
   });
@@ -281,7 +282,7 @@ TEST(Scheduler_Group, RepeatWithFirstInterval) {
   int counter = 0;
   int* counterAddress = &counter;
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.group().repeat(10, 0, 1, [counterAddress](){
     *counterAddress += 1;
   });
@@ -296,9 +297,9 @@ TEST(Scheduler_Group, RepeatWithFirstInterval) {
 
 TEST(Scheduler_Group, Clear) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.timeout(1, noop);
-  Scheduler::Group group = scheduler.group()
+  TinyScheduler::Group group = scheduler.group()
     .timeout(1, noop);
   ASSERT_EQ(scheduler.count(), 2);
   group.clear();
@@ -308,11 +309,11 @@ TEST(Scheduler_Group, Clear) {
 
 TEST(Scheduler_Group, MultipleClear) {
   timer = 0;
-  Scheduler scheduler(getTimer, delay);
+  TinyScheduler scheduler(getTimer, delay);
   scheduler.timeout(1, noop);
-  Scheduler::Group group1 = scheduler.group()
+  TinyScheduler::Group group1 = scheduler.group()
     .timeout(1, noop);
-  Scheduler::Group group2 = scheduler.group()
+  TinyScheduler::Group group2 = scheduler.group()
     .timeout(1, noop);
   ASSERT_EQ(scheduler.count(), 3);
   group1.clear();
@@ -326,7 +327,7 @@ TEST(Scheduler, TimeoutWithOverflow) {
   timer = 0;
   int counter = 0;
   int* counterAddress = &counter;
-  Scheduler scheduler(getTimer, noDelay);
+  TinyScheduler scheduler(getTimer, noDelay);
   scheduler.timeout(10, [counterAddress](){
     *counterAddress += 1;
   });
@@ -356,7 +357,7 @@ TEST(Scheduler, EveryWithOverflow) {
   timer = -5;
   int counter = 0;
   int* counterAddress = &counter;
-  Scheduler scheduler(getTimer, noDelay);
+  TinyScheduler scheduler(getTimer, noDelay);
   scheduler.every(0, 10, [counterAddress](){
     *counterAddress += 1;
   });
@@ -376,6 +377,1134 @@ TEST(Scheduler, EveryWithOverflow) {
   ASSERT_EQ(scheduler.count(), 1);
 }
 
+TEST(Scheduler, EmptyWithOverflow) {
+  timer = -5;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  ASSERT_EQ(scheduler.tick(), 0);
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 0);
+  scheduler.timeout(5, [&counter]() { counter += 1; });
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+unsigned long wallClock = 0;
+
+unsigned long getWallClock() {
+  return wallClock;
+}
+
+TEST(Scheduler_Cron, Parse) {
+  TinyScheduler::Cron cron;
+  ASSERT_TRUE(cron.parse("0 */2 * * *"));
+  ASSERT_TRUE(cron.parse("5,10-20/5 0 1 1-12 0-7"));
+  ASSERT_FALSE(cron.parse("60 * * * *"));
+  ASSERT_FALSE(cron.parse("* * *"));
+  ASSERT_FALSE(cron.parse("a * * * *"));
+  ASSERT_FALSE(cron.parse("* * * * * *"));
+}
+
+TEST(Scheduler_Cron, Next) {
+  TinyScheduler::Cron cron;
+  cron.parse("0 */2 * * *");
+  ASSERT_EQ(cron.next(0), 7200);
+  ASSERT_EQ(cron.next(7200), 14400);
+  ASSERT_EQ(cron.next(86399), 86400);
+  // monday 1970-01-05 09:30
+  cron.parse("30 9 * * 1");
+  ASSERT_EQ(cron.next(0), 379800);
+  // 1972-02-29
+  cron.parse("0 0 29 2 *");
+  ASSERT_EQ(cron.next(0), 68169600);
+  // 15th of each month or any sunday, the first sunday is 1970-01-04
+  cron.parse("0 0 15 * 0");
+  ASSERT_EQ(cron.next(0), 259200);
+  ASSERT_EQ(cron.next(259200), 864000);
+}
+
+TEST(Scheduler_Cron, Schedule) {
+  timer = 0;
+  wallClock = 30;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay, 1000);
+  scheduler.withWallClock(getWallClock).cron("* * * * *", [counterAddress](){
+    *counterAddress += 1;
+  });
+  scheduler.cron("invalid", noop);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 29999;
+  ASSERT_EQ(scheduler.tick(), 1);
+  ASSERT_EQ(counter, 0);
+  timer = 30000;
+  wallClock = 60;
+  ASSERT_EQ(scheduler.tick(), 60000);
+  ASSERT_EQ(counter, 1);
+  timer = 90000;
+  wallClock = 120;
+  scheduler.tick();
+  ASSERT_EQ(counter, 2);
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+TEST(Scheduler_Cron, Drift) {
+  timer = 0;
+  wallClock = 0;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay, 1000);
+  scheduler.withWallClock(getWallClock).cron("* * * * *", [&counter](){
+    counter += 1;
+  });
+  ASSERT_EQ(scheduler.tick(), 60000);
+  // the wall clock is 2 s behind when the first run comes
+  timer = 60000;
+  wallClock = 58;
+  ASSERT_EQ(scheduler.tick(), 62000);
+  ASSERT_EQ(counter, 1);
+  // a correction moved the wall clock 10 s ahead, the next run is placed from it
+  timer = 122000;
+  wallClock = 130;
+  ASSERT_EQ(scheduler.tick(), 50000);
+  ASSERT_EQ(counter, 2);
+}
+
+TEST(Scheduler_RateLimiter, TryAcquire) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::RateLimiter limiter = scheduler.rateLimiter(2, 10);
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_FALSE(limiter.tryAcquire());
+  timer = 9;
+  ASSERT_FALSE(limiter.tryAcquire());
+  timer = 10;
+  ASSERT_TRUE(limiter.tryAcquire());
+  timer = 1000;
+  ASSERT_EQ(limiter.available(), 2);
+  ASSERT_EQ(scheduler.count(), 0);
+}
+
+TEST(Scheduler_RateLimiter, Acquire) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::RateLimiter limiter = scheduler.rateLimiter(1, 10);
+  ASSERT_TRUE(limiter.acquire(increment));
+  timer = 4;
+  ASSERT_FALSE(limiter.acquire(increment));
+  ASSERT_FALSE(limiter.acquire(increment));
+  ASSERT_EQ(counter, 1);
+  ASSERT_EQ(scheduler.count(), 2);
+  timer = 9;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 2);
+  timer = 20;
+  scheduler.tick();
+  ASSERT_EQ(counter, 3);
+  ASSERT_FALSE(limiter.tryAcquire());
+  timer = 30;
+  ASSERT_TRUE(limiter.tryAcquire());
+}
+
+TEST(Scheduler_Debounce, Trigger) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(5, noop);
+  scheduler.timeout(20, noop);
+  auto debounced = scheduler.debounce(10, [counterAddress](){
+    *counterAddress += 1;
+  });
+  ASSERT_EQ(scheduler.count(), 2);
+  debounced.trigger();
+  ASSERT_TRUE(debounced.isPending());
+  ASSERT_EQ(scheduler.count(), 3);
+  timer = 8;
+  scheduler.tick();
+  debounced.trigger();
+  debounced.trigger();
+  ASSERT_EQ(scheduler.count(), 2);
+  timer = 17;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  timer = 18;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  ASSERT_FALSE(debounced.isPending());
+  ASSERT_EQ(scheduler.count(), 1);
+  debounced.trigger();
+  debounced.cancel();
+  timer = 100;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(Scheduler_Debounce, Lifetime) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  {
+    auto debounced = scheduler.debounce(10, noop);
+    debounced.trigger();
+    ASSERT_EQ(scheduler.count(), 1);
+  }
+  ASSERT_EQ(scheduler.count(), 0);
+  auto debounced = scheduler.debounce(10, noop);
+  debounced.trigger();
+  scheduler.clear();
+  ASSERT_FALSE(debounced.isPending());
+}
+
+TEST(Scheduler_Throttle, Trigger) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  auto throttled = scheduler.throttle(10, [counterAddress](){
+    *counterAddress += 1;
+  });
+  throttled.trigger();
+  ASSERT_EQ(counter, 1);
+  timer = 3;
+  throttled.trigger();
+  throttled.trigger();
+  ASSERT_EQ(counter, 1);
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 2);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 20;
+  scheduler.tick();
+  ASSERT_EQ(counter, 2);
+  ASSERT_EQ(scheduler.count(), 0);
+  throttled.trigger();
+  ASSERT_EQ(counter, 3);
+}
+
+TinyScheduler::Debounce<void (*)()>* selfDebounce = NULL;
+TinyScheduler::Throttle<void (*)()>* selfThrottle = NULL;
+int selfRuns = 0;
+
+void debounceAgain() {
+  selfRuns += 1;
+  if(selfRuns < 3) {
+    selfDebounce->trigger();
+  }
+}
+
+void throttleAgain() {
+  selfRuns += 1;
+  if(selfRuns < 3) {
+    selfThrottle->trigger();
+  }
+}
+
+TEST(Scheduler_Debounce, TriggerFromCallback) {
+  timer = 0;
+  selfRuns = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  auto debounced = scheduler.debounce(10, debounceAgain);
+  selfDebounce = &debounced;
+  debounced.trigger();
+  for(timer = 10; timer <= 50; timer += 10) {
+    scheduler.tick();
+    ASSERT_EQ(selfRuns, timer < 30 ? timer / 10 : 3);
+  }
+  ASSERT_FALSE(debounced.isPending());
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(Scheduler_Throttle, TriggerFromCallback) {
+  timer = 0;
+  selfRuns = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  auto throttled = scheduler.throttle(10, throttleAgain);
+  selfThrottle = &throttled;
+  throttled.trigger();
+  ASSERT_EQ(selfRuns, 1);
+  ASSERT_EQ(scheduler.count(), 1);
+  for(timer = 10; timer <= 50; timer += 10) {
+    scheduler.tick();
+    ASSERT_EQ(selfRuns, timer < 30 ? timer / 10 + 1 : 3);
+  }
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(Scheduler, Reschedule) {
+  timer = 0;
+  bool done = false;
+  bool* doneAddress = &done;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(5, noop).timeout(10, noop).timeout(15, [doneAddress](){
+    *doneAddress = true;
+  });
+  TinyScheduler::Node* node = scheduler.last();
+  ASSERT_TRUE(scheduler.reschedule(node, 1));
+  ASSERT_EQ(scheduler.tick(), 1);
+  timer = 1;
+  scheduler.tick();
+  ASSERT_TRUE(done);
+  ASSERT_EQ(scheduler.last(), (TinyScheduler::Node*) NULL);
+  ASSERT_FALSE(scheduler.reschedule(scheduler.last(), 1));
+  ASSERT_EQ(scheduler.count(), 2);
+}
+
+TEST(Scheduler, Postpone) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.every(5, [counterAddress](){
+    *counterAddress += 1;
+  });
+  TinyScheduler::Node* node = scheduler.last();
+  scheduler.timeout(7, noop).timeout(9, noop);
+  ASSERT_TRUE(scheduler.postpone(node, 5));
+  timer = 9;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  ASSERT_EQ(scheduler.tick(), 1);
+  ASSERT_TRUE(scheduler.setInterval(node, 2));
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  timer = 12;
+  scheduler.tick();
+  ASSERT_EQ(counter, 2);
+  ASSERT_FALSE(scheduler.setInterval(scheduler.timeout(1, noop).last(), 2));
+}
+
+typedef BasicTinyScheduler<uint16_t, uint16_t, uint8_t> CompactScheduler;
+
+TEST(Scheduler_Compact, Size) {
+  // vtable, links and successor, the narrow fields share the last word
+  ASSERT_LE(sizeof(CompactScheduler::Node), 4 * sizeof(void*) + 8);
+  ASSERT_LT(sizeof(CompactScheduler::Node), sizeof(TinyScheduler::Node));
+  ASSERT_LT(sizeof(CompactScheduler::PeriodicNode<void (*)()>), sizeof(TinyScheduler::PeriodicNode<void (*)()>));
+}
+
+TEST(Scheduler_Compact, EveryWithOverflow) {
+  timer = 65530;
+  int counter = 0;
+  int* counterAddress = &counter;
+  CompactScheduler scheduler(getTimer, noDelay);
+  scheduler.every(10, [counterAddress](){
+    *counterAddress += 1;
+  });
+  scheduler.group().timeout(20, noop);
+  timer = 65535;
+  ASSERT_EQ(scheduler.tick(), 5);
+  ASSERT_EQ(counter, 0);
+  timer = 65536 + 4;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  timer = 65536 + 14;
+  scheduler.tick();
+  ASSERT_EQ(counter, 2);
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+TEST(Scheduler_Wide, Timeout) {
+  timer = 0;
+  bool done = false;
+  bool* doneAddress = &done;
+  BasicTinyScheduler<uint64_t> scheduler(getTimer, noDelay);
+  scheduler.timeout(5, [doneAddress](){
+    *doneAddress = true;
+  });
+  timer = 5;
+  scheduler.tick();
+  ASSERT_TRUE(done);
+}
+
+int taskCounter = 0;
+
+void incrementTaskCounter() {
+  taskCounter += 1;
+}
+
+TEST(Scheduler_Task, Arm) {
+  timer = 0;
+  taskCounter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Task task(incrementTaskCounter);
+  scheduler.timeout(5, noop);
+  scheduler.arm(task, 10);
+  ASSERT_TRUE(task.isArmed());
+  ASSERT_EQ(scheduler.count(), 2);
+  scheduler.arm(task, 3);
+  ASSERT_EQ(scheduler.count(), 2);
+  ASSERT_EQ(scheduler.tick(), 3);
+  timer = 3;
+  scheduler.tick();
+  ASSERT_EQ(taskCounter, 1);
+  ASSERT_FALSE(task.isArmed());
+  ASSERT_FALSE(scheduler.disarm(task));
+  scheduler.arm(task, 10);
+  ASSERT_TRUE(scheduler.disarm(task));
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+TEST(Scheduler_Task, Reschedule) {
+  timer = 0;
+  taskCounter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Task task(incrementTaskCounter);
+  ASSERT_FALSE(scheduler.reschedule(task, 5));
+  scheduler.arm(task, 10, 10);
+  ASSERT_TRUE(scheduler.reschedule(task, 3));
+  ASSERT_TRUE(scheduler.postpone(task, 2));
+  ASSERT_TRUE(scheduler.setInterval(task, 20));
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 20);
+  ASSERT_EQ(taskCounter, 1);
+  scheduler.disarm(task);
+  // the task outlives its runs, so it is still a valid handle
+  ASSERT_FALSE(scheduler.postpone(task, 5));
+  ASSERT_FALSE(scheduler.setInterval(task, 5));
+}
+
+TEST(Scheduler_Task, Every) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  {
+    TinyScheduler::BasicTask<decltype(increment)> task(increment);
+    scheduler.arm(task, 0, 2);
+    for(timer=0;timer<10;timer++) {
+      scheduler.tick();
+      ASSERT_EQ(counter, timer / 2 + 1);
+    }
+    ASSERT_EQ(scheduler.count(), 1);
+  }
+  ASSERT_EQ(scheduler.count(), 0);
+}
+
+TinyScheduler* rearmScheduler = NULL;
+TinyScheduler::Task* rearmTask = NULL;
+int rearmRuns = 0;
+
+void rearmOnce() {
+  rearmRuns += 1;
+  if(rearmRuns < 3) {
+    rearmScheduler->arm(*rearmTask, 5);
+  }
+}
+
+void rearmPeriodic() {
+  rearmRuns += 1;
+  if(rearmRuns == 1) {
+    rearmScheduler->arm(*rearmTask, 50, 10);
+  }
+}
+
+TEST(Scheduler_Task, RearmFromCallback) {
+  timer = 0;
+  rearmRuns = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Task task(rearmOnce);
+  rearmScheduler = &scheduler;
+  rearmTask = &task;
+  scheduler.arm(task, 5);
+  for(timer = 5; timer <= 30; timer += 5) {
+    scheduler.tick();
+    ASSERT_EQ(rearmRuns, timer < 15 ? timer / 5 : 3);
+  }
+  ASSERT_FALSE(task.isArmed());
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(Scheduler_Task, RearmPeriodicFromCallback) {
+  timer = 0;
+  rearmRuns = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Task task(rearmPeriodic);
+  rearmScheduler = &scheduler;
+  rearmTask = &task;
+  scheduler.timeout(20, noop);
+  scheduler.arm(task, 5, 5);
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 15);
+  ASSERT_EQ(rearmRuns, 1);
+  ASSERT_EQ(task.getWhen(), 55);
+  timer = 20;
+  ASSERT_EQ(scheduler.tick(), 35);
+  ASSERT_EQ(rearmRuns, 1);
+  timer = 55;
+  ASSERT_EQ(scheduler.tick(), 10);
+  timer = 65;
+  scheduler.tick();
+  ASSERT_EQ(rearmRuns, 3);
+  ASSERT_TRUE(scheduler.disarm(task));
+}
+
+unsigned long getMillis() {
+  return timer / 1000;
+}
+
+TEST(Scheduler_Multi, TickAll) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler ms(getMillis, noDelay, 1000);
+  TinyScheduler us(getTimer, noDelay, 1000000);
+  ASSERT_EQ(tickAll(ms, us), 0);
+  ms.timeout(5, increment);
+  us.timeout(3000, increment);
+  ASSERT_EQ(tickAll(ms, us), 3000);
+  timer = 3000;
+  ASSERT_EQ(tickAll(ms, us), 2000);
+  ASSERT_EQ(counter, 1);
+  timer = 5000;
+  ASSERT_EQ(tickAll(ms, us), 0);
+  ASSERT_EQ(counter, 2);
+  ASSERT_TRUE(ms.isEmpty() && us.isEmpty());
+}
+
+TEST(Scheduler_Multi, ToMicros) {
+  TinyScheduler ms(getMillis, noDelay, 1000);
+  TinyScheduler us(getTimer, noDelay, 1000000);
+  TinyScheduler hz(getTimer, noDelay, 3);
+  TinyScheduler ns(getTimer, noDelay, 1000000000);
+  ASSERT_EQ(ms.toMicros(7), 7000);
+  ASSERT_EQ(us.toMicros(5000), 5000);
+  ASSERT_EQ(us.toMicros(2999999), 2999999);
+  ASSERT_EQ(hz.toMicros(4), 1333333);
+  ASSERT_EQ(ns.toMicros(999999999), 999999);
+  ASSERT_EQ(ms.toMicros((unsigned long) -1), (unsigned long) -1);
+}
+
+TEST(Scheduler_Spread, Hash) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withPhaseSpreading(TinyScheduler::SPREAD_HASH);
+  for(int i = 0; i < 100; i++) {
+    scheduler.every(100, increment);
+  }
+  int previous = 0;
+  for(timer = 1; timer <= 100; timer++) {
+    scheduler.tick();
+    ASSERT_LE(counter - previous, 2);
+    previous = counter;
+  }
+  ASSERT_EQ(counter, 100);
+  for(; timer <= 200; timer++) {
+    scheduler.tick();
+  }
+  ASSERT_EQ(counter, 200);
+}
+
+TEST(Scheduler_Spread, Random) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withPhaseSpreading(TinyScheduler::SPREAD_RANDOM);
+  for(int i = 0; i < 100; i++) {
+    scheduler.group().every(1000, increment);
+  }
+  timer = 500;
+  scheduler.tick();
+  ASSERT_GT(counter, 0);
+  ASSERT_LT(counter, 100);
+  timer = 1000;
+  scheduler.tick();
+  ASSERT_EQ(counter, 100);
+}
+
+TEST(Scheduler_Spread, None) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  for(int i = 0; i < 10; i++) {
+    scheduler.every(100, increment);
+  }
+  timer = 99;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  timer = 100;
+  scheduler.tick();
+  ASSERT_EQ(counter, 10);
+}
+
+TEST(Scheduler_Chain, Then) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(10, increment).then(20, increment).then(5, increment);
+  ASSERT_EQ(scheduler.count(), 1);
+  ASSERT_TRUE(scheduler.last()->isWaiting());
+  timer = 10;
+  ASSERT_EQ(scheduler.tick(), 20);
+  ASSERT_EQ(counter, 1);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 30;
+  ASSERT_EQ(scheduler.tick(), 5);
+  ASSERT_EQ(counter, 2);
+  timer = 35;
+  scheduler.tick();
+  ASSERT_EQ(counter, 3);
+  ASSERT_TRUE(scheduler.isEmpty());
+  ASSERT_EQ(scheduler.last(), nullptr);
+}
+
+TEST(Scheduler_Chain, ThenRepeat) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.repeat(3, 10, noop).then(0, increment);
+  for(timer = 0; timer < 30; timer++) {
+    scheduler.tick();
+    ASSERT_EQ(counter, 0);
+  }
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(Scheduler_Chain, After) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Node* predecessors[2];
+  scheduler.timeout(5, noop);
+  predecessors[0] = scheduler.last();
+  scheduler.timeout(15, noop);
+  predecessors[1] = scheduler.last();
+  scheduler.after(predecessors, 10, increment);
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 10);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 15;
+  ASSERT_EQ(scheduler.tick(), 10);
+  timer = 24;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  timer = 25;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(Scheduler_Chain, AfterRejected) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withCapacity(1);
+  TinyScheduler::Node* predecessors[2];
+  scheduler.timeout(5, noop);
+  predecessors[0] = scheduler.last();
+  // rejected, so there is nothing to wait for
+  scheduler.timeout(15, noop);
+  predecessors[1] = scheduler.last();
+  ASSERT_EQ(predecessors[1], (TinyScheduler::Node*) NULL);
+  scheduler.withCapacity(2);
+  scheduler.after(predecessors, 10, [counterAddress](){
+    *counterAddress += 1;
+  });
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 10);
+  timer = 15;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(Scheduler_Chain, Reject) {
+  timer = 0;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Node* predecessors[1];
+  scheduler.timeout(5, [&counter]() { counter += 1; });
+  predecessors[0] = scheduler.last();
+  scheduler.then(1, [&counter]() { counter *= 10; });
+  ASSERT_TRUE(scheduler.last() != NULL);
+  scheduler.after(predecessors, 1, [&counter]() { counter += 100; });
+  ASSERT_EQ(scheduler.last(), nullptr);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  timer = 6;
+  scheduler.tick();
+  ASSERT_EQ(counter, 10);
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(Scheduler_Chain, ThenArmed) {
+  timer = 0;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  {
+    TinyScheduler::Task task(noop);
+    scheduler.timeout(100, [&counter]() { counter += 1; });
+    scheduler.arm(task, 5);
+    ASSERT_EQ(scheduler.last(), &task);
+    scheduler.then(1, [&counter]() { counter += 10; });
+    ASSERT_EQ(scheduler.last(), nullptr);
+    scheduler.arm(task, 5);
+  }
+  ASSERT_EQ(scheduler.last(), nullptr);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 100;
+  scheduler.tick();
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+}
+
+TEST(Scheduler_Chain, Cancel) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Group group = scheduler.group();
+  TinyScheduler::Node* predecessors[2];
+  group.timeout(5, noop).then(5, increment);
+  predecessors[0] = scheduler.last();
+  scheduler.timeout(5, noop);
+  predecessors[1] = scheduler.last();
+  scheduler.after(predecessors, 0, increment).then(0, increment);
+  group.clear();
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 20;
+  scheduler.tick();
+  ASSERT_EQ(counter, 0);
+  ASSERT_TRUE(scheduler.isEmpty());
+  ASSERT_EQ(scheduler.last(), nullptr);
+}
+
+int timerReads = 0;
+
+unsigned long countTimerReads() {
+  timerReads += 1;
+  return timer;
+}
+
+TEST(Scheduler_Batch, SingleClockRead) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  auto increment = [counterAddress](){
+    *counterAddress += 1;
+  };
+  TinyScheduler scheduler(countTimerReads, noDelay);
+  for(int i = 0; i < 100; i++) {
+    scheduler.every(10 + i % 3, increment);
+  }
+  timerReads = 0;
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 5);
+  ASSERT_EQ(timerReads, 1);
+  timerReads = 0;
+  timer = 12;
+  ASSERT_EQ(scheduler.tick(), 8);
+  // once for the due scan and once after the tasks ran
+  ASSERT_EQ(timerReads, 2);
+  ASSERT_EQ(counter, 100);
+  ASSERT_EQ(scheduler.count(), 100);
+  timer = 25;
+  scheduler.tick();
+  ASSERT_EQ(counter, 200);
+  timer = 100;
+  scheduler.tick();
+  ASSERT_EQ(counter, 34 * 10 + 33 * 9 + 33 * 8);
+}
+
+TEST(Scheduler_Batch, SlowTask) {
+  timer = 0;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(0, []() {
+    timer += 50;
+  });
+  scheduler.timeout(30, [&counter]() {
+    counter += 1;
+  });
+  scheduler.timeout(80, []() {});
+  // the task due during the slow one ran late, so there is no wait to trust
+  ASSERT_EQ(scheduler.tick(), 0);
+  ASSERT_EQ(counter, 1);
+  ASSERT_EQ(scheduler.count(), 1);
+  ASSERT_EQ(scheduler.tick(), 30);
+  scheduler.timeout(0, []() {
+    timer += 20;
+  });
+  ASSERT_EQ(scheduler.tick(), 10);
+  ASSERT_EQ(timer, 70);
+}
+
+TEST(Scheduler_Batch, CancelDuringTick) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Group group = scheduler.group();
+  TinyScheduler::Group* groupAddress = &group;
+  scheduler.every(5, [counterAddress, groupAddress](){
+    *counterAddress += 1;
+    groupAddress->clear();
+  });
+  group.every(6, [counterAddress](){
+    *counterAddress += 100;
+  });
+  group.timeout(6, [counterAddress](){
+    *counterAddress += 100;
+  });
+  timer = 6;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  ASSERT_EQ(scheduler.count(), 1);
+  scheduler.clear();
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST(Scheduler_Forward, MoveOnly) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  std::unique_ptr<int> payload(new int(5));
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(5, [counterAddress, payload = std::move(payload)](){
+    *counterAddress += *payload;
+  });
+  std::unique_ptr<int> step(new int(1));
+  scheduler.group().every(5, [counterAddress, step = std::move(step)](){
+    *counterAddress += *step;
+  });
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(counter, 6);
+  std::unique_ptr<int> settled(new int(10));
+  auto debounced = scheduler.debounce(5, [counterAddress, settled = std::move(settled)](){
+    *counterAddress += *settled;
+  });
+  std::unique_ptr<int> limited(new int(100));
+  auto throttled = scheduler.throttle(5, [counterAddress, limited = std::move(limited)](){
+    *counterAddress += *limited;
+  });
+  std::unique_ptr<int> armed(new int(1000));
+  auto work = [counterAddress, armed = std::move(armed)](){
+    *counterAddress += *armed;
+  };
+  TinyScheduler::BasicTask<decltype(work)> task(std::move(work));
+  debounced.trigger();
+  throttled.trigger();
+  scheduler.arm(task, 5);
+  ASSERT_EQ(counter, 106);
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1117);
+}
+
+int copies = 0;
+
+struct CountCopies {
+  int* counter;
+  CountCopies(int* counter) : counter(counter) {}
+  CountCopies(const CountCopies& other) : counter(other.counter) {
+    copies += 1;
+  }
+  CountCopies(CountCopies&& other) : counter(other.counter) {}
+  void operator()() const {
+    *this->counter += 1;
+  }
+};
+
+TEST(Scheduler_Forward, Copies) {
+  timer = 0;
+  int counter = 0;
+  CountCopies callable(&counter);
+  TinyScheduler scheduler(getTimer, noDelay);
+  copies = 0;
+  scheduler.timeout(5, CountCopies(&counter));
+  scheduler.repeat(2, 5, CountCopies(&counter)).then(0, CountCopies(&counter));
+  ASSERT_EQ(copies, 0);
+  scheduler.every(5, callable);
+  ASSERT_EQ(copies, 1);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(counter, 3);
+}
+
+class StringStream : public Stream {
+public:
+  std::string text;
+  int available() { return 0; }
+  int read() { return -1; }
+  int peek() { return -1; }
+  void flush() {}
+  size_t write(uint8_t c) {
+    text += (char) c;
+    return 1;
+  }
+};
+
+TEST(Scheduler_Snapshot, Visit) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(20, noop);
+  scheduler.group().every(10, noop);
+  unsigned long previous = 0;
+  int visited = 0;
+  scheduler.visit([&](const TinyScheduler::Node& node) {
+    ASSERT_GE(node.getWhen(), previous);
+    previous = node.getWhen();
+    visited += 1;
+  });
+  ASSERT_EQ(visited, 2);
+  ASSERT_EQ(previous, 20);
+}
+
+TEST(Scheduler_Snapshot, Json) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  TinyScheduler::Group group = scheduler.group();
+  scheduler.timeout(5, noop);
+  group.timeout(10, noop);
+  group.every(30, noop);
+  scheduler.group().timeout(40, noop);
+  timer = 7;
+  unsigned int groups[3];
+  TinyScheduler::Snapshot snapshot = scheduler.snapshot(groups, 3);
+  ASSERT_EQ(snapshot.count, 4);
+  ASSERT_EQ(snapshot.overdue, 1);
+  ASSERT_EQ(snapshot.earliest, 3);
+  ASSERT_EQ(snapshot.latest, 33);
+  ASSERT_EQ(groups[0], 1);
+  ASSERT_EQ(groups[1], 2);
+  ASSERT_EQ(groups[2], 1);
+  StringStream json;
+  snapshot.toJson(json);
+  ASSERT_EQ(json.text, "{\"count\":4,\"overdue\":1,\"earliest\":3,\"latest\":33,\"groups\":[1,2,1]}");
+  scheduler.tick();
+  json.text = "";
+  scheduler.snapshot().toJson(json);
+  ASSERT_EQ(json.text, "{\"count\":3,\"overdue\":0,\"earliest\":3,\"latest\":33,\"groups\":[]}");
+}
+
+TEST(Scheduler_Snapshot, PeriodicDebug) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.every(10, noop);
+  StringStream text;
+  scheduler.last()->debug(text);
+  ASSERT_EQ(text.text.find("PeriodicNode {"), 0);
+}
+
+struct CountHooks {
+  int inserts = 0;
+  int begins = 0;
+  int ends = 0;
+  int done = 0;
+  int cancels = 0;
+  int rescans = 0;
+  int idles = 0;
+  template<typename Node> void onInsert(const Node& node) { inserts += 1; }
+  template<typename Node> void onDispatchBegin(const Node& node) { begins += 1; }
+  template<typename Node> void onDispatchEnd(const Node& node, bool finished) {
+    ends += 1;
+    done += finished;
+  }
+  void onBatchBegin() {}
+  void onBatchEnd() {}
+  template<typename Node> void onCancel(const Node& node) { cancels += 1; }
+  void onOverflowRescan() { rescans += 1; }
+  template<typename Time> void onIdle(Time wait) { idles += 1; }
+};
+
+typedef BasicTinyScheduler<unsigned long, unsigned long, unsigned long, CountHooks> HookedScheduler;
+
+TEST(Scheduler_Hooks, Calls) {
+  timer = 0;
+  HookedScheduler scheduler(getTimer, noDelay);
+  HookedScheduler::Group group = scheduler.group();
+  scheduler.timeout(5, noop);
+  scheduler.every(5, noop);
+  group.timeout(20, noop);
+  ASSERT_EQ(scheduler.hooks().inserts, 3);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(scheduler.hooks().begins, 2);
+  ASSERT_EQ(scheduler.hooks().ends, 2);
+  ASSERT_EQ(scheduler.hooks().done, 1);
+  group.clear();
+  ASSERT_EQ(scheduler.hooks().cancels, 1);
+  scheduler.clear();
+  ASSERT_EQ(scheduler.hooks().cancels, 2);
+  timer = (unsigned long) -5;
+  scheduler.tick();
+  scheduler.timeout(10, noop);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(scheduler.hooks().rescans, 1);
+  ASSERT_EQ(scheduler.hooks().done, 2);
+}
+
+TEST(Scheduler_Hooks, Idle) {
+  timer = 0;
+  HookedScheduler scheduler(getTimer, [](unsigned long wait) {
+    timer += wait;
+  });
+  scheduler.repeat(3, 10, noop);
+  scheduler.loop();
+  ASSERT_EQ(scheduler.hooks().idles, 3);
+  ASSERT_EQ(sizeof(TinyScheduler), sizeof(BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyNoHooks>));
+}
+
+TEST(Scheduler_Admission, Reject) {
+  timer = 0;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withCapacity(2);
+  ASSERT_TRUE(scheduler.timeout(5, [&counter]() { counter += 1; }).last() != NULL);
+  ASSERT_TRUE(scheduler.every(5, noop).last() != NULL);
+  ASSERT_TRUE(scheduler.timeout(1, noop).last() == NULL);
+  ASSERT_TRUE(scheduler.timeout(1, noop).then(0, noop).last() == NULL);
+  ASSERT_EQ(scheduler.count(), 2);
+  ASSERT_EQ(scheduler.getRejected(), 2);
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1);
+  ASSERT_TRUE(scheduler.repeat(2, 5, noop).last() != NULL);
+  ASSERT_EQ(scheduler.count(), 2);
+  scheduler.clear();
+  ASSERT_TRUE(scheduler.timeout(1, noop).timeout(1, noop).last() != NULL);
+}
+
+TEST(Scheduler_Admission, DropOldest) {
+  timer = 0;
+  int counter = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withCapacity(2, TinyScheduler::ADMIT_DROP_OLDEST);
+  scheduler.timeout(10, [&counter]() { counter += 1; });
+  scheduler.timeout(5, [&counter]() { counter += 10; });
+  scheduler.every(1, noop);
+  ASSERT_EQ(scheduler.count(), 2);
+  ASSERT_EQ(scheduler.getDropped(), 1);
+  scheduler.timeout(20, [&counter]() { counter += 100; });
+  ASSERT_EQ(scheduler.getDropped(), 2);
+  timer = 20;
+  scheduler.tick();
+  ASSERT_EQ(counter, 100);
+  scheduler.every(2, noop);
+  ASSERT_TRUE(scheduler.every(3, noop).last() == NULL);
+  ASSERT_EQ(scheduler.getRejected(), 1);
+}
+
+TEST(Scheduler_Admission, DropLowestPriority) {
+  timer = 0;
+  int counter = 0;
+  HookedScheduler scheduler(getTimer, noDelay);
+  scheduler.withCapacity(3, HookedScheduler::ADMIT_DROP_LOWEST_PRIORITY);
+  scheduler.priority(2).timeout(5, [&counter]() { counter += 1; });
+  scheduler.priority(1).timeout(5, [&counter]() { counter += 10; });
+  scheduler.priority(1).timeout(8, [&counter]() { counter += 100; });
+  ASSERT_TRUE(scheduler.timeout(1, noop).last() == NULL);
+  ASSERT_TRUE(scheduler.priority(1).timeout(1, noop).last() == NULL);
+  ASSERT_TRUE(scheduler.priority(3).timeout(1, noop).last() != NULL);
+  ASSERT_EQ(scheduler.getRejected(), 2);
+  ASSERT_EQ(scheduler.getDropped(), 1);
+  ASSERT_EQ(scheduler.hooks().cancels, 1);
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 11);
+  ASSERT_TRUE(scheduler.isEmpty());
+}
+
+int shared = 0;
+
+void sharedOne() {
+  shared += 1;
+}
+
+void sharedTen() {
+  shared += 10;
+}
+
+TEST(Scheduler_Shared, Bucket) {
+  timer = 0;
+  shared = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  for(int i = 0; i < 1000; i++) {
+    scheduler.everyShared(10, i % 2 == 0 ? sharedOne : sharedTen);
+  }
+  TinyScheduler::Node* bucket = scheduler.last();
+  scheduler.everyShared(20, sharedOne);
+  timer = 1;
+  scheduler.everyShared(10, sharedOne);
+  ASSERT_EQ(scheduler.count(), 3);
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(shared, 5500);
+  timer = 11;
+  scheduler.tick();
+  ASSERT_EQ(shared, 5501);
+  timer = 20;
+  scheduler.tick();
+  ASSERT_EQ(shared, 11002);
+  ASSERT_EQ(scheduler.count(), 3);
+  ASSERT_EQ(bucket->getWhen(), 30);
+  scheduler.clear();
+  timer = 21;
+  scheduler.everyShared(10, sharedOne);
+  ASSERT_TRUE(scheduler.last() != bucket);
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
+TEST(Scheduler_Shared, Capacity) {
+  timer = 0;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withCapacity(1);
+  scheduler.everyShared(10, sharedOne);
+  scheduler.everyShared(10, sharedTen);
+  ASSERT_TRUE(scheduler.last() != NULL);
+  ASSERT_TRUE(scheduler.everyShared(20, sharedOne).last() == NULL);
+  ASSERT_EQ(scheduler.getRejected(), 1);
+  ASSERT_EQ(scheduler.count(), 1);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,67 @@
+#include "TinyStaticScheduler.h"
+
+#include "Arduino.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+unsigned long timer = 0;
+
+unsigned long getTimer() {
+  return timer;
+}
+
+void noDelay(unsigned long ignore) {
+
+}
+
+int fast = 0;
+int slow = 0;
+
+void incrementFast() {
+  fast += 1;
+}
+
+void incrementSlow() {
+  slow += 1;
+}
+
+TEST(StaticScheduler, Every) {
+  timer = 0;
+  fast = 0;
+  slow = 0;
+  TinyStaticScheduler<Every<2, incrementFast>, Every<5, incrementSlow>> scheduler(getTimer, noDelay);
+  ASSERT_EQ(scheduler.count(), 2);
+  for(timer=0;timer<20;timer++) {
+    scheduler.tick();
+    ASSERT_EQ(fast, timer / 2);
+    ASSERT_EQ(slow, timer / 5);
+  }
+}
+
+TEST(StaticScheduler, LeftTime) {
+  timer = 0;
+  TinyStaticScheduler<Every<7, incrementFast>, Every<5, incrementSlow, 3>> scheduler(getTimer, noDelay);
+  ASSERT_EQ(scheduler.tick(), 3);
+  timer = 3;
+  ASSERT_EQ(scheduler.tick(), 4);
+  timer = 7;
+  ASSERT_EQ(scheduler.tick(), 1);
+}
+
+TEST(StaticScheduler, Overflow) {
+  timer = -3;
+  fast = 0;
+  TinyStaticScheduler<Every<5, incrementFast>> scheduler(getTimer, noDelay);
+  timer = 1;
+  scheduler.tick();
+  ASSERT_EQ(fast, 0);
+  timer = 2;
+  scheduler.tick();
+  ASSERT_EQ(fast, 1);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,103 @@
+#include "TinyThreadPool.h"
+
+#include "Arduino.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+unsigned long timer = 0;
+
+unsigned long getTimer() {
+  return timer;
+}
+
+void noDelay(unsigned long ignore) {
+
+}
+
+TEST(ThreadPool, Batch) {
+  timer = 0;
+  std::atomic<int> counter(0);
+  std::atomic<int>* counterAddress = &counter;
+  TinyThreadPool<TinyScheduler> pool(4);
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withExecutor(&pool);
+  for(int i = 0; i < 64; i++) {
+    scheduler.every(5, [counterAddress]() {
+      *counterAddress += 1;
+    }).independent();
+  }
+  scheduler.timeout(5, [counterAddress]() {
+    *counterAddress += 1000;
+  });
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 5);
+  ASSERT_EQ(counter, 1064);
+  ASSERT_EQ(scheduler.count(), 64);
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(counter, 1128);
+}
+
+std::atomic<int> runs(0);
+
+void countRun() {
+  runs += 1;
+}
+
+TEST(ThreadPool, Task) {
+  timer = 0;
+  TinyThreadPool<TinyScheduler> pool(2);
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withExecutor(&pool);
+  TinyScheduler::Task task(countRun);
+  scheduler.arm(task, 5, 5).independent();
+  timer = 5;
+  ASSERT_EQ(scheduler.tick(), 5);
+  ASSERT_EQ(runs, 1);
+  ASSERT_TRUE(task.isArmed());
+  timer = 10;
+  scheduler.tick();
+  ASSERT_EQ(runs, 2);
+  scheduler.disarm(task);
+}
+
+TEST(ThreadPool, Parallel) {
+  timer = 0;
+  TinyThreadPool<TinyScheduler> pool(4);
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.withExecutor(&pool);
+  for(int i = 0; i < 8; i++) {
+    scheduler.timeout(1, []() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }).independent();
+  }
+  timer = 1;
+  auto start = std::chrono::steady_clock::now();
+  scheduler.tick();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_TRUE(scheduler.isEmpty());
+  ASSERT_LT(elapsed, std::chrono::milliseconds(8 * 20));
+}
+
+TEST(ThreadPool, WithoutExecutor) {
+  timer = 0;
+  int counter = 0;
+  int* counterAddress = &counter;
+  TinyScheduler scheduler(getTimer, noDelay);
+  scheduler.repeat(2, 5, [counterAddress]() {
+    *counterAddress += 1;
+  }).independent().then(0, [counterAddress]() {
+    *counterAddress += 10;
+  });
+  for(timer = 0; timer <= 10; timer++) {
+    scheduler.tick();
+  }
+  ASSERT_EQ(counter, 12);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
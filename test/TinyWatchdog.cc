@@ -0,0 +1,150 @@
+#include "TinyWatchdogThread.h"
+
+#include "Arduino.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+unsigned long timer = 0;
+
+unsigned long getTimer() {
+  return timer;
+}
+
+void noDelay(unsigned long ignore) {
+
+}
+
+typedef BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyWatchdog> WatchedScheduler;
+
+TinyOverrun lastOverrun;
+
+void saveOverrun(const TinyOverrun& overrun) {
+  lastOverrun = overrun;
+}
+
+TEST(Watchdog, Overrun) {
+  timer = 0;
+  lastOverrun = TinyOverrun();
+  WatchedScheduler scheduler(getTimer, noDelay);
+  scheduler.hooks().begin(getTimer, 10, saveOverrun);
+  WatchedScheduler::Group group = scheduler.group();
+  group.timeout(5, []() {
+    timer += 30;
+  });
+  const void* slow = scheduler.last();
+  scheduler.timeout(10, []() {});
+  scheduler.timeout(20, []() {});
+  scheduler.timeout(50, []() {});
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(scheduler.hooks().getOverruns(), 1);
+  ASSERT_EQ(lastOverrun.task, slow);
+  ASSERT_EQ(lastOverrun.elapsed, 30);
+  ASSERT_NE(lastOverrun.groupId, 0);
+  // the tasks due during the overrun run in the same tick
+  ASSERT_EQ(scheduler.hooks().getSlipped(), 2);
+  ASSERT_EQ(scheduler.count(), 1);
+  timer = 50;
+  scheduler.tick();
+  ASSERT_EQ(scheduler.hooks().getSlipped(), 2);
+}
+
+void advance(unsigned long wait) {
+  timer += wait;
+}
+
+TEST(Watchdog, Loop) {
+  timer = 0;
+  lastOverrun = TinyOverrun();
+  WatchedScheduler scheduler(getTimer, advance);
+  scheduler.hooks().begin(getTimer, 10, saveOverrun);
+  scheduler.timeout(5, []() {
+    timer += 30;
+  });
+  scheduler.timeout(10, []() {});
+  scheduler.timeout(20, []() {});
+  scheduler.timeout(50, []() {});
+  scheduler.loop();
+  ASSERT_EQ(timer, 50);
+  ASSERT_EQ(scheduler.hooks().getOverruns(), 1);
+  ASSERT_EQ(scheduler.hooks().getSlipped(), 2);
+}
+
+class SerialExecutor : public WatchedScheduler::Executor {
+public:
+  void execute(WatchedScheduler::Node* first) {
+    for(WatchedScheduler::Node* node = first; node != NULL; node = node->getNext()) {
+      node->dispatch();
+    }
+  }
+};
+
+TEST(Watchdog, Batch) {
+  timer = 0;
+  lastOverrun = TinyOverrun();
+  SerialExecutor executor;
+  WatchedScheduler scheduler(getTimer, noDelay);
+  scheduler.withExecutor(&executor);
+  scheduler.hooks().begin(getTimer, 10, saveOverrun);
+  scheduler.timeout(5, []() {}).independent();
+  scheduler.timeout(5, []() {
+    timer += 30;
+  }).independent();
+  scheduler.timeout(5, []() {}).independent();
+  scheduler.timeout(5, []() {}).independent();
+  timer = 5;
+  scheduler.tick();
+  ASSERT_TRUE(scheduler.isEmpty());
+  ASSERT_EQ(scheduler.hooks().getOverruns(), 1);
+  ASSERT_EQ(lastOverrun.task, (const void*) NULL);
+  ASSERT_EQ(lastOverrun.elapsed, 30);
+  scheduler.timeout(5, []() {
+    timer += 20;
+  });
+  timer = 40;
+  scheduler.tick();
+  ASSERT_EQ(scheduler.hooks().getOverruns(), 2);
+  ASSERT_NE(lastOverrun.task, (const void*) NULL);
+  ASSERT_EQ(lastOverrun.elapsed, 20);
+}
+
+TEST(Watchdog, Disabled) {
+  timer = 0;
+  WatchedScheduler scheduler(getTimer, noDelay);
+  scheduler.timeout(5, []() {
+    timer += 30;
+  });
+  timer = 5;
+  scheduler.tick();
+  ASSERT_EQ(scheduler.hooks().getOverruns(), 0);
+}
+
+std::atomic<int> stalls(0);
+
+void countStall(const TinyOverrun& overrun) {
+  stalls += 1;
+}
+
+TEST(Watchdog, Thread) {
+  BasicTinyScheduler<unsigned long, unsigned long, unsigned long, TinyWatchdogThread> scheduler(millis, delay);
+  scheduler.hooks().begin(millis, 20, NULL, countStall);
+  std::atomic<int>* stallsAddress = &stalls;
+  bool seen = false;
+  bool* seenAddress = &seen;
+  scheduler.timeout(0, [stallsAddress, seenAddress]() {
+    for(int i = 0; i < 500 && *stallsAddress == 0; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    *seenAddress = *stallsAddress == 1;
+  });
+  scheduler.loop();
+  ASSERT_TRUE(seen);
+  ASSERT_EQ(scheduler.hooks().getStalls(), 1);
+  ASSERT_EQ(scheduler.hooks().getOverruns(), 1);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}